@@ -0,0 +1,281 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+/**
+ * @brief Arena class
+ *
+ * Carves allocations out of large pages with a bump pointer. Small freed slots are
+ * kept in per-size free lists and reused by the next allocation of the same size class,
+ * so node-sized churn does not grow the arena. Reset() returns all memory at once.
+ *
+ * @warning the arena is not thread-safe
+ */
+class arena_t {
+private:
+  /**
+   * @brief Page header class
+   *
+   * Placed at the beginning of every page allocated from the system
+   */
+  struct page_t {
+    page_t* next;             ///< pointer to previously allocated page (nullptr for the first one)
+    size_t size;              ///< size of the page in bytes including this header
+  };
+
+  /**
+   * @brief Free slot class
+   *
+   * Placed in freed small slots to link them in a free list
+   */
+  struct slot_t {
+    slot_t* next;             ///< pointer to next free slot of the same size class
+  };
+
+  static constexpr size_t granularity = alignof(std::max_align_t);   ///< size class step in bytes
+  static constexpr size_t sizeClasses = 16;                          ///< number of size classes with free lists
+  static constexpr size_t headerSize = (sizeof(page_t) + granularity - 1) / granularity * granularity;
+
+  page_t* pages;              ///< list of regular pages, the current one first
+  page_t* largePages;         ///< list of dedicated pages of large allocations
+  char* cur;                  ///< first free byte of the current page
+  char* end;                  ///< end of the current page
+  size_t pageSize;            ///< size of regular pages in bytes
+  slot_t* freeSlots[sizeClasses];   ///< free lists of small slots by size class
+
+  /**
+   * @brief Allocate page from the system
+   * @param[in] size size of the page in bytes including header
+   * @param[in] next page to link after the new one
+   * @return pointer to the page
+   */
+  static page_t* NewPage(size_t size, page_t* next) {
+    page_t* page = static_cast<page_t*>(::operator new(size));
+    page->next = next;
+    page->size = size;
+    return page;
+  }
+
+  /**
+   * @brief Free list of pages to the system
+   * @param[in] page first page of the list
+   */
+  static void DeletePages(page_t* page) noexcept {
+    while (page != nullptr) {
+      page_t* next = page->next;
+      ::operator delete(page);
+      page = next;
+    }
+  }
+
+  /**
+   * @brief Align address up
+   * @param[in] address address to align
+   * @param[in] alignment required alignment (power of two)
+   * @return the smallest aligned address not less than given one
+   */
+  static char* AlignUp(char* address, size_t alignment) {
+    std::uintptr_t value = reinterpret_cast<std::uintptr_t>(address);
+    return address + (((value + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1)) - value);
+  }
+
+  /**
+   * @brief Get size class of allocation
+   * @param[in] bytes size of allocation
+   * @return index of free list to use (sizeClasses for large allocations)
+   */
+  static size_t SizeClass(size_t bytes) {
+    size_t index = (bytes + granularity - 1) / granularity;
+    return index == 0 ? 0 : (index <= sizeClasses ? index - 1 : sizeClasses);
+  }
+
+public:
+  /**
+   * @brief Constructor of empty arena
+   * @param[in] pageSize size of regular pages in bytes
+   */
+  explicit arena_t(size_t pageSize = 64 * 1024)
+    : pages(nullptr), largePages(nullptr), cur(nullptr), end(nullptr), pageSize(pageSize > 2 * headerSize ? pageSize : 2 * headerSize), freeSlots() {};
+
+  arena_t(arena_t const&) = delete;
+  arena_t& operator=(arena_t const&) = delete;
+
+  /**
+   * @brief Allocate memory from arena
+   * @param[in] bytes size of allocation
+   * @param[in] alignment required alignment (at most alignof(std::max_align_t) for reusable slots)
+   * @return pointer to allocated memory
+   */
+  void* Allocate(size_t bytes, size_t alignment) {
+    size_t sizeClass = SizeClass(bytes);
+    if (sizeClass < sizeClasses && alignment <= granularity) {
+      if (slot_t* slot = freeSlots[sizeClass]) {
+        freeSlots[sizeClass] = slot->next;
+        return slot;
+      }
+      bytes = (sizeClass + 1) * granularity;
+    }
+
+    if (bytes + alignment > pageSize - headerSize) {
+      largePages = NewPage(headerSize + bytes + alignment, largePages);
+      return AlignUp(reinterpret_cast<char*>(largePages) + headerSize, alignment);
+    }
+
+    char* address = AlignUp(cur, alignment);
+    if (cur == nullptr || address + bytes > end) {
+      pages = NewPage(pageSize, pages);
+      cur = reinterpret_cast<char*>(pages) + headerSize;
+      end = reinterpret_cast<char*>(pages) + pageSize;
+      address = AlignUp(cur, alignment);
+    }
+
+    cur = address + bytes;
+    return address;
+  }
+
+  /**
+   * @brief Return memory to arena
+   *
+   * Small slots are put to the free list of their size class, large ones are kept until reset.
+   *
+   * @param[in] pointer pointer to memory returned by Allocate
+   * @param[in] bytes size of allocation
+   * @param[in] alignment alignment the memory was allocated with
+   */
+  void Deallocate(void* pointer, size_t bytes, size_t alignment) noexcept {
+    size_t sizeClass = SizeClass(bytes);
+    if (sizeClass < sizeClasses && alignment <= granularity) {
+      slot_t* slot = static_cast<slot_t*>(pointer);
+      slot->next = freeSlots[sizeClass];
+      freeSlots[sizeClass] = slot;
+    }
+  }
+
+  /**
+   * @brief Forget all allocations keeping the current page for reuse
+   * @warning all memory allocated from the arena becomes invalid
+   */
+  void Reset() noexcept {
+    DeletePages(largePages);
+    largePages = nullptr;
+    for (size_t i = 0; i < sizeClasses; ++i)
+      freeSlots[i] = nullptr;
+
+    if (pages != nullptr) {
+      DeletePages(pages->next);
+      pages->next = nullptr;
+      cur = reinterpret_cast<char*>(pages) + headerSize;
+    }
+  }
+
+  /**
+   * @brief Free all pages to the system
+   * @warning all memory allocated from the arena becomes invalid
+   */
+  void Release() noexcept {
+    Reset();
+    if (pages != nullptr)
+      ::operator delete(pages);
+    pages = nullptr;
+    cur = nullptr;
+    end = nullptr;
+  }
+
+  /**
+   * @brief Arena destructor
+   */
+  ~arena_t() {
+    Release();
+  }
+};
+
+/**
+ * @brief Allocator taking memory from arena_t
+ *
+ * Stateful allocator which copies and rebinds share the same arena. It declares
+ * 'is_resettable', so containers may drop their nodes at once on request
+ * and leave the memory to arena_t::Reset().
+ *
+ * @tparam T type of allocated objects
+ */
+template <typename T>
+class arena_allocator {
+  template <typename U>
+  friend class arena_allocator;
+
+private:
+  arena_t* arena;             ///< arena to allocate from
+
+public:
+  using value_type = T;
+  using is_always_equal = std::false_type;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_resettable = std::true_type;   ///< memory is reclaimed by arena reset, deallocation may be skipped
+
+  /**
+   * @brief Constructor from arena
+   * @param[in] arena arena to allocate from (must outlive the allocator and its copies)
+   */
+  arena_allocator(arena_t& arena) noexcept : arena(&arena) {};
+
+  /**
+   * @brief Rebinding constructor
+   * @param[in] other allocator to share arena with
+   */
+  template <typename U>
+  arena_allocator(arena_allocator<U> const& other) noexcept : arena(other.arena) {};
+
+  /**
+   * @brief Allocate memory for objects
+   * @param[in] n number of objects
+   * @return pointer to uninitialized memory
+   */
+  T* allocate(size_t n) {
+    if (n > static_cast<size_t>(-1) / sizeof(T))
+      throw std::bad_array_new_length();
+    return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T)));
+  }
+
+  /**
+   * @brief Return memory to arena
+   * @param[in] pointer pointer returned by allocate
+   * @param[in] n number of objects
+   */
+  void deallocate(T* pointer, size_t n) noexcept {
+    arena->Deallocate(pointer, n * sizeof(T), alignof(T));
+  }
+
+  /**
+   * @brief Get arena of this allocator
+   * @return reference to the arena
+   */
+  arena_t& Arena() const noexcept {
+    return *arena;
+  }
+
+  /**
+   * @brief Equality operator
+   * @param[in] other allocator to compare
+   * @return true if allocators share the same arena
+   */
+  template <typename U>
+  bool operator==(arena_allocator<U> const& other) const noexcept {
+    return arena == other.arena;
+  }
+
+  /**
+   * @brief Inequality operator
+   * @param[in] other allocator to compare
+   * @return true if allocators use different arenas
+   */
+  template <typename U>
+  bool operator!=(arena_allocator<U> const& other) const noexcept {
+    return arena != other.arena;
+  }
+};
@@ -0,0 +1,415 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "deque.h"
+
+/**
+ * @brief Coroutine deque class
+ *
+ * Thread-safe deque whose pops are awaited: co_await PopFrontAsync() completes at once if
+ * there is an element and suspends the coroutine while the deque is empty. A push given to
+ * a waiting coroutine bypasses the storage and resumes the coroutine on the pushing thread,
+ * or hands it to the executor if one is set. Waiters are served in FIFO order.
+ *
+ * Under fan-in load wakeups are batched on both sides: PushBackBatch() feeds and resumes
+ * all waiters it can with one lock, and PopFrontBatchAsync() takes every queued element
+ * (up to a limit) per wakeup, so a busy consumer is not suspended per element.
+ *
+ * @tparam T type of stored elements
+ * @tparam Allocator the allocator to be used
+ * @warning a suspended pop must not be destroyed before it is resumed; Close() resumes all of them
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class async_deque_t {
+public:
+  using executor_t = std::function<void(std::coroutine_handle<>)>;  ///< schedules resumption of a coroutine
+
+private:
+  /**
+   * @brief Suspended pop
+   *
+   * Lives in the awaiter, i.e. in the frame of the suspended coroutine.
+   */
+  struct waiter_t {
+    waiter_t* next;                     ///< next waiter in the queue
+    std::coroutine_handle<> handle;     ///< coroutine to resume
+    std::optional<T>* single;           ///< destination of single pop (nullptr for batch pop)
+    std::vector<T>* batch;              ///< destination of batch pop (nullptr for single pop)
+    size_t max;                         ///< maximum number of elements of batch pop
+  };
+
+  deque_t<T, Allocator> deque;          ///< elements nobody waits for (empty while there are waiters)
+  waiter_t* waitersHead;                ///< the longest waiting pop (nullptr if none)
+  waiter_t* waitersTail;                ///< the latest waiting pop (nullptr if none)
+  bool closed;                          ///< true if Close() was called
+  executor_t executor;                  ///< resumes woken coroutines (empty to resume on the pushing thread)
+  mutable std::mutex mutex;             ///< protects all members except 'executor'
+
+  /**
+   * @brief Give queued elements to pop
+   * @param[in] waiter the pop
+   * @return true if at least one element was given, false if deque is empty
+   */
+  bool Take(waiter_t& waiter) {
+    if (deque.IsEmpty())
+      return false;
+
+    if (waiter.single != nullptr) {
+      waiter.single->emplace(std::move(deque.Front()));
+      deque.PopFront();
+    }
+    else
+      deque.PopFrontN(waiter.max, std::back_inserter(*waiter.batch));
+    return true;
+  }
+
+  /**
+   * @brief Give pushed element to pop
+   * @param[in] waiter the pop
+   * @param[in] value element to give
+   */
+  template <typename U>
+  static void Give(waiter_t& waiter, U&& value) {
+    if (waiter.single != nullptr)
+      waiter.single->emplace(std::forward<U>(value));
+    else
+      waiter.batch->push_back(std::forward<U>(value));
+  }
+
+  /**
+   * @brief Remove the longest waiting pop from the queue
+   * @return the pop with 'next' reset
+   */
+  waiter_t* Dequeue() {
+    waiter_t* waiter = waitersHead;
+    waitersHead = waiter->next;
+    if (waitersHead == nullptr)
+      waitersTail = nullptr;
+    waiter->next = nullptr;
+    return waiter;
+  }
+
+  /**
+   * @brief Complete pop at once or put it to the queue
+   * @param[in] waiter the pop
+   * @param[in] handle coroutine awaiting the pop
+   * @return true if the coroutine is suspended, false if it continues
+   */
+  bool Suspend(waiter_t& waiter, std::coroutine_handle<> handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (Take(waiter) || closed)
+      return false;
+
+    waiter.next = nullptr;
+    waiter.handle = handle;
+    if (waitersTail != nullptr)
+      waitersTail->next = &waiter;
+    else
+      waitersHead = &waiter;
+    waitersTail = &waiter;
+    return true;
+  }
+
+  /**
+   * @brief Resume coroutines of chain of pops
+   *
+   * A resumed coroutine may destroy its pop, so the link to the next one is read first.
+   *
+   * @param[in] waiter first pop of the chain linked by 'next' (may be nullptr)
+   */
+  void Resume(waiter_t* waiter) {
+    while (waiter != nullptr) {
+      waiter_t* next = waiter->next;
+      std::coroutine_handle<> handle = waiter->handle;
+      if (executor)
+        executor(handle);
+      else
+        handle.resume();
+      waiter = next;
+    }
+  }
+
+  /**
+   * @brief Push element to end of deque or give it to the longest waiting pop
+   * @param[in] value element to add
+   * @return false if deque is closed, true otherwise
+   */
+  template <typename U>
+  bool Push(U&& value) {
+    waiter_t* woken;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (closed)
+        return false;
+      if (waitersHead == nullptr) {
+        deque.PushBack(std::forward<U>(value));
+        return true;
+      }
+      Give(*waitersHead, std::forward<U>(value));
+      woken = Dequeue();
+    }
+    Resume(woken);
+    return true;
+  }
+
+public:
+  /**
+   * @brief Awaiter of single pop
+   */
+  class pop_awaiter_t {
+    friend class async_deque_t;
+
+  private:
+    async_deque_t& owner;               ///< deque to pop from
+    waiter_t waiter;                    ///< the pop in the queue of waiters
+    std::optional<T> value;             ///< the popped element
+
+    /**
+     * @brief Constructor of pop
+     * @param[in] owner deque to pop from
+     */
+    explicit pop_awaiter_t(async_deque_t& owner) : owner(owner), waiter() {};
+
+  public:
+    pop_awaiter_t(pop_awaiter_t const&) = delete;
+    pop_awaiter_t& operator=(pop_awaiter_t const&) = delete;
+
+    bool await_ready() const noexcept {
+      return false;
+    }
+
+    /**
+     * @brief Take element or suspend coroutine
+     * @param[in] handle the awaiting coroutine
+     * @return true if the coroutine is suspended
+     */
+    bool await_suspend(std::coroutine_handle<> handle) {
+      waiter.single = &value;
+      waiter.batch = nullptr;
+      waiter.max = 1;
+      return owner.Suspend(waiter, handle);
+    }
+
+    /**
+     * @brief Get result of pop
+     * @return the element (std::nullopt if deque is closed and empty)
+     */
+    std::optional<T> await_resume() {
+      return std::move(value);
+    }
+  };
+
+  /**
+   * @brief Awaiter of batch pop
+   */
+  class batch_awaiter_t {
+    friend class async_deque_t;
+
+  private:
+    async_deque_t& owner;               ///< deque to pop from
+    waiter_t waiter;                    ///< the pop in the queue of waiters
+    std::vector<T> values;              ///< the popped elements
+    size_t max;                         ///< maximum number of elements
+
+    /**
+     * @brief Constructor of pop
+     * @param[in] owner deque to pop from
+     * @param[in] max maximum number of elements (0 is taken as 1)
+     */
+    batch_awaiter_t(async_deque_t& owner, size_t max) : owner(owner), waiter(), max(max != 0 ? max : 1) {};
+
+  public:
+    batch_awaiter_t(batch_awaiter_t const&) = delete;
+    batch_awaiter_t& operator=(batch_awaiter_t const&) = delete;
+
+    bool await_ready() const noexcept {
+      return false;
+    }
+
+    /**
+     * @brief Take elements or suspend coroutine
+     * @param[in] handle the awaiting coroutine
+     * @return true if the coroutine is suspended
+     */
+    bool await_suspend(std::coroutine_handle<> handle) {
+      waiter.single = nullptr;
+      waiter.batch = &values;
+      waiter.max = max;
+      return owner.Suspend(waiter, handle);
+    }
+
+    /**
+     * @brief Get result of pop
+     * @return the elements in order (empty if deque is closed and empty)
+     */
+    std::vector<T> await_resume() {
+      return std::move(values);
+    }
+  };
+
+  /**
+   * @brief Constructor of empty deque
+   * @param[in] executor resumes woken coroutines (empty to resume them on the pushing thread)
+   * @param[in] alloc allocator to use in deque
+   */
+  explicit async_deque_t(executor_t executor = executor_t(), Allocator const& alloc = Allocator())
+    : deque(alloc), waitersHead(nullptr), waitersTail(nullptr), closed(false), executor(std::move(executor)) {};
+
+  async_deque_t(async_deque_t const&) = delete;
+  async_deque_t& operator=(async_deque_t const&) = delete;
+
+  /**
+   * @brief Get deque size method
+   * @return number of queued elements
+   */
+  size_t Size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return deque.Size();
+  }
+
+  /**
+   * @brief Check is deque empty method
+   * @return true if no elements are queued, false otherwise
+   */
+  bool IsEmpty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return deque.IsEmpty();
+  }
+
+  /**
+   * @brief Check is deque closed
+   * @return true if Close() was called, false otherwise
+   */
+  bool IsClosed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return closed;
+  }
+
+  /**
+   * @brief Put element to end of deque
+   *
+   * If a coroutine waits, the element is given to it and the coroutine is resumed
+   * before returning (or handed to the executor).
+   *
+   * @param[in] value element to add
+   * @return false if deque is closed, true otherwise
+   */
+  bool PushBack(T const& value) {
+    return Push(value);
+  }
+
+  /**
+   * @brief Put element to end of deque
+   * @param[in] value element to move
+   * @return false if deque is closed, true otherwise
+   */
+  bool PushBack(T&& value) {
+    return Push(std::move(value));
+  }
+
+  /**
+   * @brief Put range of elements to end of deque
+   *
+   * Elements are given to waiting coroutines first (a batch pop takes up to its limit),
+   * the rest is queued; all woken coroutines are resumed after the lock is released.
+   *
+   * @param[in] first begin of the range
+   * @param[in] last end of the range
+   * @return false if deque is closed, true otherwise
+   */
+  template <typename InputIt>
+  bool PushBackBatch(InputIt first, InputIt last) {
+    waiter_t* wokenHead = nullptr;
+    waiter_t** wokenTail = &wokenHead;
+    std::exception_ptr error;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (closed)
+        return false;
+
+      try {
+        while (first != last && waitersHead != nullptr) {
+          waiter_t* waiter = waitersHead;
+          size_t given = 0;
+          do {
+            Give(*waiter, *first);
+            ++first;
+            ++given;
+          } while (first != last && waiter->batch != nullptr && given < waiter->max);
+
+          *wokenTail = Dequeue();
+          wokenTail = &waiter->next;
+        }
+        deque.PushBackRange(first, last);
+      }
+      catch (...) {
+        // coroutines already given elements are still resumed
+        error = std::current_exception();
+      }
+    }
+
+    Resume(wokenHead);
+    if (error)
+      std::rethrow_exception(error);
+    return true;
+  }
+
+  /**
+   * @brief Pop element from the front, suspending while deque is empty
+   * @return awaiter giving std::optional<T> (std::nullopt if deque is closed and empty)
+   */
+  pop_awaiter_t PopFrontAsync() {
+    return pop_awaiter_t(*this);
+  }
+
+  /**
+   * @brief Pop queued elements from the front, suspending while deque is empty
+   * @param[in] max maximum number of elements (0 is taken as 1)
+   * @return awaiter giving std::vector<T> of 1 to 'max' elements (empty if deque is closed and empty)
+   */
+  batch_awaiter_t PopFrontBatchAsync(size_t max) {
+    return batch_awaiter_t(*this, max);
+  }
+
+  /**
+   * @brief Pop element from the front without waiting
+   * @param[out] value the popped element
+   * @return true if an element was popped, false if deque is empty
+   */
+  bool TryPopFront(T& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (deque.IsEmpty())
+      return false;
+    value = std::move(deque.Front());
+    deque.PopFront();
+    return true;
+  }
+
+  /**
+   * @brief Close deque
+   *
+   * Further pushes fail, waiting coroutines are resumed with no element;
+   * queued elements can still be popped.
+   */
+  void Close() {
+    waiter_t* woken;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      closed = true;
+      woken = waitersHead;
+      waitersHead = nullptr;
+      waitersTail = nullptr;
+    }
+    Resume(woken);
+  }
+};
@@ -0,0 +1,329 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "block_deque.h"
+#include "blocking_deque.h"
+#include "concurrent_deque.h"
+#include "deque.h"
+#include "ring_deque.h"
+
+#ifndef DEQUE_BENCH_MAX_SIZE
+#define DEQUE_BENCH_MAX_SIZE (1 << 20)
+#endif
+
+/**
+ * @brief 64-byte trivially copyable element
+ */
+struct pod64_t {
+  int64_t key;                ///< value the element is made from
+  int64_t payload[7];         ///< padding to 64 bytes
+};
+
+/**
+ * @brief Make element of benchmarked type
+ * @param[in] i number of the element
+ * @return the element
+ */
+template <typename T>
+T MakeValue(size_t i) {
+  if constexpr (std::is_same_v<T, std::string>)
+    return std::string(32, (char)('a' + i % 26));   // longer than small string buffer
+  else if constexpr (std::is_same_v<T, pod64_t>)
+    return pod64_t{ (int64_t)i, {} };
+  else
+    return T(i);
+}
+
+/**
+ * @brief Get number from element, so loops over elements are not optimized out
+ * @param[in] value the element
+ * @return number depending on the element
+ */
+template <typename T>
+size_t Touch(T const& value) {
+  if constexpr (std::is_same_v<T, std::string>)
+    return value.size();
+  else if constexpr (std::is_same_v<T, pod64_t>)
+    return (size_t)value.key;
+  else
+    return (size_t)value;
+}
+
+// Operations spelled as in this repository or as in the standard library
+
+template <typename C, typename V>
+void PushBack(C& c, V&& value) {
+  if constexpr (requires { c.PushBack(std::forward<V>(value)); })
+    c.PushBack(std::forward<V>(value));
+  else
+    c.push_back(std::forward<V>(value));
+}
+
+template <typename C, typename V>
+void PushFront(C& c, V&& value) {
+  if constexpr (requires { c.PushFront(std::forward<V>(value)); })
+    c.PushFront(std::forward<V>(value));
+  else
+    c.push_front(std::forward<V>(value));
+}
+
+template <typename C>
+void PopFront(C& c) {
+  if constexpr (requires { c.PopFront(); })
+    c.PopFront();
+  else
+    c.pop_front();
+}
+
+template <typename C>
+void PopBack(C& c) {
+  if constexpr (requires { c.PopBack(); })
+    c.PopBack();
+  else
+    c.pop_back();
+}
+
+template <typename C>
+void Clear(C& c) {
+  if constexpr (requires { c.Clear(); })
+    c.Clear();
+  else
+    c.clear();
+}
+
+template <typename C>
+void Fill(C& c, size_t n) {
+  using T = std::remove_cvref_t<decltype(*c.begin())>;
+  for (size_t i = 0; i < n; ++i)
+    PushBack(c, MakeValue<T>(i));
+}
+
+template <typename C>
+void BM_PushBack(benchmark::State& state) {
+  using T = std::remove_cvref_t<decltype(*C().begin())>;
+  size_t n = (size_t)state.range(0);
+  for (auto _ : state) {
+    C c;
+    for (size_t i = 0; i < n; ++i)
+      PushBack(c, MakeValue<T>(i));
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)n);
+}
+
+template <typename C>
+void BM_PushFront(benchmark::State& state) {
+  using T = std::remove_cvref_t<decltype(*C().begin())>;
+  size_t n = (size_t)state.range(0);
+  for (auto _ : state) {
+    C c;
+    for (size_t i = 0; i < n; ++i)
+      PushFront(c, MakeValue<T>(i));
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)n);
+}
+
+template <typename C>
+void BM_PopFront(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  for (auto _ : state) {
+    state.PauseTiming();
+    C c;
+    Fill(c, n);
+    state.ResumeTiming();
+    for (size_t i = 0; i < n; ++i)
+      PopFront(c);
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)n);
+}
+
+template <typename C>
+void BM_FifoChurn(benchmark::State& state) {
+  using T = std::remove_cvref_t<decltype(*C().begin())>;
+  C c;
+  Fill(c, (size_t)state.range(0));
+  size_t i = 0;
+  for (auto _ : state) {
+    PushBack(c, MakeValue<T>(i++));
+    PopFront(c);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename C>
+void BM_MixedChurn(benchmark::State& state) {
+  using T = std::remove_cvref_t<decltype(*C().begin())>;
+  C c;
+  Fill(c, (size_t)state.range(0));
+  uint32_t pattern = 0x9e3779b9u;
+  size_t i = 0;
+  for (auto _ : state) {
+    // xorshift picks the end, so branch prediction cannot learn the pattern
+    pattern ^= pattern << 13;
+    pattern ^= pattern >> 17;
+    pattern ^= pattern << 5;
+    if (pattern & 1)
+      PushFront(c, MakeValue<T>(i++));
+    else
+      PushBack(c, MakeValue<T>(i++));
+    if (pattern & 2)
+      PopFront(c);
+    else
+      PopBack(c);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename C>
+void BM_Iterate(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  C c;
+  Fill(c, n);
+  for (auto _ : state) {
+    size_t sum = 0;
+    for (auto const& value : c)
+      sum += Touch(value);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)n);
+}
+
+template <typename C>
+void BM_Copy(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  C c;
+  Fill(c, n);
+  for (auto _ : state) {
+    C copy(c);
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)n);
+}
+
+template <typename C>
+void BM_Clear(benchmark::State& state) {
+  size_t n = (size_t)state.range(0);
+  C c;
+  for (auto _ : state) {
+    state.PauseTiming();
+    Fill(c, n);
+    state.ResumeTiming();
+    Clear(c);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * (int64_t)n);
+}
+
+/**
+ * @brief std::deque behind a mutex, the baseline for thread-safe deques
+ */
+struct locked_std_deque_t {
+  std::mutex mutex;           ///< protects the deque
+  std::deque<int> deque;      ///< stored elements
+
+  bool TryPushBack(int value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    deque.push_back(value);
+    return true;
+  }
+
+  bool TryPopFront(int& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (deque.empty())
+      return false;
+    value = deque.front();
+    deque.pop_front();
+    return true;
+  }
+};
+
+/**
+ * @brief Every thread pushes to the back and pops from the front of one shared deque
+ */
+template <typename Q>
+void BM_ConcurrentFifo(benchmark::State& state) {
+  static Q* queue = nullptr;
+  if (state.thread_index() == 0)
+    queue = new Q();
+
+  int value = state.thread_index();
+  size_t popped = 0;
+  for (auto _ : state) {
+    queue->TryPushBack(value);
+    popped += queue->TryPopFront(value);
+  }
+  benchmark::DoNotOptimize(popped);
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    delete queue;
+    queue = nullptr;
+  }
+}
+
+/**
+ * @brief Register benchmark over sizes from 8 to DEQUE_BENCH_MAX_SIZE
+ * @param[in] name name of the benchmark
+ * @param[in] fn the benchmark
+ */
+void RegisterSized(std::string const& name, void (*fn)(benchmark::State&)) {
+  benchmark::RegisterBenchmark(name.c_str(), fn)->RangeMultiplier(8)->Range(8, DEQUE_BENCH_MAX_SIZE);
+}
+
+template <typename C>
+void RegisterContainer(std::string const& container, std::string const& type) {
+  std::string suffix = "/" + container + "<" + type + ">";
+  RegisterSized("PushBack" + suffix, BM_PushBack<C>);
+  RegisterSized("PushFront" + suffix, BM_PushFront<C>);
+  RegisterSized("PopFront" + suffix, BM_PopFront<C>);
+  RegisterSized("FifoChurn" + suffix, BM_FifoChurn<C>);
+  RegisterSized("MixedChurn" + suffix, BM_MixedChurn<C>);
+  RegisterSized("Iterate" + suffix, BM_Iterate<C>);
+  RegisterSized("Copy" + suffix, BM_Copy<C>);
+  RegisterSized("Clear" + suffix, BM_Clear<C>);
+}
+
+template <typename T>
+void RegisterType(std::string const& type) {
+  RegisterContainer<deque_t<T>>("deque_t", type);
+  RegisterContainer<block_deque_t<T>>("block_deque_t", type);
+  RegisterContainer<ring_deque_t<T>>("ring_deque_t", type);
+  RegisterContainer<std::deque<T>>("std::deque", type);
+  RegisterContainer<std::list<T>>("std::list", type);
+}
+
+template <typename Q>
+void RegisterConcurrent(std::string const& name) {
+  benchmark::RegisterBenchmark(("ConcurrentFifo/" + name).c_str(), BM_ConcurrentFifo<Q>)->ThreadRange(1, 8)->UseRealTime();
+}
+
+/*
+ * Results are printed as a table, '--benchmark_format=json' (or '--benchmark_out=<file>
+ * --benchmark_out_format=json') gives JSON for dashboards, '--benchmark_filter=<regex>'
+ * selects benchmarks.
+ */
+int main(int argc, char** argv) {
+  RegisterType<int>("int");
+  RegisterType<pod64_t>("pod64");
+  RegisterType<std::string>("string");
+  RegisterConcurrent<concurrent_deque_t<int>>("concurrent_deque_t<int>");
+  RegisterConcurrent<blocking_deque_t<int>>("blocking_deque_t<int>");
+  RegisterConcurrent<locked_std_deque_t>("std::deque<int>+mutex");
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,869 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Default number of elements in one block of block_deque_t
+ * @tparam T type of stored elements
+ * @return the largest power of two elements fitting in 4 KiB, but not less than 16
+ */
+template <typename T>
+constexpr size_t DefaultBlockSize() {
+  size_t target = sizeof(T) < 4096 / 16 ? 4096 / sizeof(T) : 16;
+  size_t blockSize = 1;
+  while (blockSize * 2 <= target)
+    blockSize *= 2;
+  return blockSize;
+}
+
+/**
+ * @brief Block deque class
+ *
+ * Elements are stored in fixed-size blocks which addresses are kept in a central map
+ * (the same layout as std::deque). Pushes and pops at both ends are O(1) and allocate
+ * memory only once per 'BlockSize' elements.
+ *
+ * @tparam T type of stored elements
+ * @tparam Allocator the allocator to be used
+ * @tparam BlockSize number of elements in one block (must be a power of two)
+ */
+template <typename T, typename Allocator = std::allocator<T>, size_t BlockSize = DefaultBlockSize<T>()>
+class block_deque_t {
+  static_assert(BlockSize > 0 && (BlockSize & (BlockSize - 1)) == 0, "BlockSize must be a power of two");
+
+private:
+  using alloc_traits = std::allocator_traits<Allocator>;  //allocator traits
+  using map_allocator = typename alloc_traits::template rebind_alloc<T*>;
+  using map_allocator_traits = typename alloc_traits::template rebind_traits<T*>;
+
+  static constexpr size_t blockMask = BlockSize - 1;    ///< mask of the position inside a block
+  static constexpr size_t initialMapSize = 8;           ///< number of map slots allocated on first push
+
+  T** map;                    ///< array of pointers to blocks (nullptr for the slots without elements)
+  size_t mapSize;             ///< number of slots in the map (one more nullptr slot is allocated after them)
+  size_t start;               ///< position of the first element counting from the beginning of the first slot
+  size_t size;                ///< size in elements in the deque
+  T* spare;                   ///< released block kept to avoid reallocation at block boundaries (may be nullptr)
+
+  Allocator alloc;            ///< the allocator for blocks
+  map_allocator mapAlloc;     ///< the allocator for the map
+
+  /**
+   * @brief Block deque iterator class
+   * @tparam IsConst const's of this iterator
+   */
+  template <bool IsConst>
+  class common_iterator {
+    friend class block_deque_t;
+    template <bool> friend class common_iterator;
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, T const*, T*>;
+    using reference = std::conditional_t<IsConst, T const&, T&>;
+
+  private:
+    T* cur;                   ///< pointer to the element (nullptr for end iterator on a block boundary)
+    T* first;                 ///< pointer to the beginning of the current block
+    T* const* node;           ///< pointer to the map slot of the current block
+
+    /**
+     * @brief Constructor from map slot and position inside a block
+     * @param[in] node pointer to the map slot
+     * @param[in] offset position inside the block
+     */
+    common_iterator(T* const* node, size_t offset) : cur(*node ? *node + offset : nullptr), first(*node), node(node) {};
+
+  public:
+    /**
+     * @brief Default constructor
+     */
+    common_iterator() : cur(nullptr), first(nullptr), node(nullptr) {};
+
+    /**
+     * @brief Conversion from non-const iterator
+     * @param[in] other iterator to convert
+     */
+    template <bool WasConst, typename = std::enable_if_t<IsConst && !WasConst>>
+    common_iterator(common_iterator<WasConst> const& other) : cur(other.cur), first(other.first), node(other.node) {};
+
+    /**
+     * @brief Dereference operator *
+     * @return reference (const reference for const iterator) to the pointed-to element
+     */
+    reference operator*() const {
+      return *cur;
+    }
+
+    /**
+     * @brief Dereference operator ->
+     * @return pointer (const pointer for const iterator) to the pointed-to element
+     */
+    pointer operator->() const {
+      return cur;
+    }
+
+    /**
+     * @brief Prefix increment
+     * @return reference to this iterator
+     */
+    common_iterator& operator++() {
+      if (++cur == first + BlockSize) {
+        ++node;
+        first = *node;
+        cur = first;
+      }
+      return *this;
+    }
+
+    /**
+     * @brief Postfix increment
+     * @return previous value of this iterator
+     */
+    common_iterator operator++(int) {
+      common_iterator tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    /**
+     * @brief Prefix decrement
+     * @return reference to this iterator
+     */
+    common_iterator& operator--() {
+      if (cur == first) {
+        --node;
+        first = *node;
+        cur = first + BlockSize;
+      }
+      --cur;
+      return *this;
+    }
+
+    /**
+     * @brief Postfix decrement
+     * @return previous value of this iterator
+     */
+    common_iterator operator--(int) {
+      common_iterator tmp = *this;
+      --(*this);
+      return tmp;
+    }
+
+    /**
+     * @brief Equality operator
+     * @param[in] other iterator to compare
+     * @return true if iterators point to the same element else false
+     */
+    bool operator==(common_iterator const& other) const {
+      return cur == other.cur && node == other.node;
+    }
+
+    /**
+     * @brief Inequality operator
+     * @param[in] other iterator to compare
+     * @return true if iterators point to the different elements else false
+     */
+    bool operator!=(common_iterator const& other) const {
+      return !(*this == other);
+    }
+
+    /**
+     * @brief Move iterator forward
+     * @param[in] n number of elements (may be negative)
+     * @return reference to this iterator
+     */
+    common_iterator& operator+=(difference_type n) {
+      difference_type offset = (cur - first) + n;
+      if (offset >= 0 && offset < (difference_type)BlockSize)
+        cur += n;
+      else {
+        difference_type nodeOffset = offset >= 0 ? offset / (difference_type)BlockSize
+          : -((-offset - 1) / (difference_type)BlockSize) - 1;
+        node += nodeOffset;
+        first = *node;
+        cur = first + (offset - nodeOffset * (difference_type)BlockSize);
+      }
+      return *this;
+    }
+
+    /**
+     * @brief Difference operator
+     * @param[in] other iterator to subtract
+     * @return number of elements between the iterators
+     */
+    difference_type operator-(common_iterator const& other) const {
+      return (node - other.node) * (difference_type)BlockSize + (cur - first) - (other.cur - other.first);
+    }
+
+    /**
+     * @brief Less operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator points before the other one
+     */
+    bool operator<(common_iterator const& other) const {
+      return node == other.node ? cur < other.cur : node < other.node;
+    }
+
+    /**
+     * @brief Subscript operator
+     * @param[in] n offset from this iterator
+     * @return reference (const reference for const iterator) to the element at the offset
+     */
+    reference operator[](difference_type n) const {
+      return *(*this + n);
+    }
+
+    /**
+     * @brief Move iterator backward
+     * @param[in] n number of elements
+     * @return reference to this iterator
+     */
+    common_iterator& operator-=(difference_type n) {
+      return *this += -n;
+    }
+
+    /**
+     * @brief Get iterator moved forward
+     * @param[in] n number of elements
+     * @return moved iterator
+     */
+    common_iterator operator+(difference_type n) const {
+      common_iterator tmp = *this;
+      return tmp += n;
+    }
+
+    /**
+     * @brief Get iterator moved forward
+     * @param[in] n number of elements
+     * @param[in] it iterator to move
+     * @return moved iterator
+     */
+    friend common_iterator operator+(difference_type n, common_iterator const& it) {
+      return it + n;
+    }
+
+    /**
+     * @brief Get iterator moved backward
+     * @param[in] n number of elements
+     * @return moved iterator
+     */
+    common_iterator operator-(difference_type n) const {
+      common_iterator tmp = *this;
+      return tmp += -n;
+    }
+
+    /**
+     * @brief Greater operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator points after the other one
+     */
+    bool operator>(common_iterator const& other) const {
+      return other < *this;
+    }
+
+    /**
+     * @brief Less or equal operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator does not point after the other one
+     */
+    bool operator<=(common_iterator const& other) const {
+      return !(other < *this);
+    }
+
+    /**
+     * @brief Greater or equal operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator does not point before the other one
+     */
+    bool operator>=(common_iterator const& other) const {
+      return !(*this < other);
+    }
+  };
+
+  /**
+   * @brief Get block for a map slot from the spare or the allocator
+   * @return pointer to uninitialized block
+   */
+  T* AcquireBlock() {
+    if (spare != nullptr) {
+      T* block = spare;
+      spare = nullptr;
+      return block;
+    }
+    return alloc_traits::allocate(alloc, BlockSize);
+  }
+
+  /**
+   * @brief Return emptied block to the spare or the allocator
+   * @param[in] block pointer to block without alive elements
+   */
+  void ReleaseBlock(T* block) {
+    if (spare == nullptr)
+      spare = block;
+    else
+      alloc_traits::deallocate(alloc, block, BlockSize);
+  }
+
+  /**
+   * @brief Make room for one more block at the front or at the back of the map
+   *
+   * Used slots are recentered in the current map if it is less than half full,
+   * otherwise the map is reallocated with doubled size.
+   *
+   * @param[in] atFront true if the room is needed before the first element
+   */
+  void GrowMap(bool atFront) {
+    size_t firstSlot = start / BlockSize;
+    size_t usedSlots = size == 0 ? 0 : (start + size - 1) / BlockSize - firstSlot + 1;
+    size_t newUsedSlots = usedSlots + 1;
+    size_t newFirstSlot;
+
+    if (mapSize > 2 * newUsedSlots) {
+      newFirstSlot = (mapSize - newUsedSlots) / 2 + (atFront ? 1 : 0);
+      std::memmove(map + newFirstSlot, map + firstSlot, usedSlots * sizeof(T*));
+      for (size_t i = 0; i < mapSize; ++i)
+        if (i < newFirstSlot || i >= newFirstSlot + usedSlots)
+          map[i] = nullptr;
+    }
+    else {
+      size_t newMapSize = mapSize == 0 ? initialMapSize : mapSize + (mapSize > newUsedSlots ? mapSize : newUsedSlots) + 2;
+      T** newMap = map_allocator_traits::allocate(mapAlloc, newMapSize + 1);
+
+      newFirstSlot = (newMapSize - newUsedSlots) / 2 + (atFront ? 1 : 0);
+      for (size_t i = 0; i <= newMapSize; ++i)
+        newMap[i] = nullptr;
+      if (usedSlots != 0)
+        std::memcpy(newMap + newFirstSlot, map + firstSlot, usedSlots * sizeof(T*));
+      if (map != nullptr)
+        map_allocator_traits::deallocate(mapAlloc, map, mapSize + 1);
+
+      map = newMap;
+      mapSize = newMapSize;
+    }
+
+    start = newFirstSlot * BlockSize + (start & blockMask);
+  }
+
+  /**
+   * @brief Set first position of empty deque to the middle of the map
+   */
+  void Recenter() {
+    start = (mapSize / 2) * BlockSize;
+  }
+
+public:
+  /**
+   * @brief Constructor of empty deque
+   * @param[in] alloc allocator to use in deque
+   */
+  block_deque_t(Allocator const& alloc = Allocator())
+    : map(nullptr), mapSize(0), start(0), size(0), spare(nullptr), alloc(alloc), mapAlloc(alloc) {};
+
+  /**
+   * @brief Copy constructor
+   *
+   * The map is allocated for all elements at once; trivially copyable elements are
+   * copied with memcpy block by block.
+   *
+   * @param[in] other deque to copy
+   */
+  block_deque_t(block_deque_t const& other)
+    : block_deque_t(alloc_traits::select_on_container_copy_construction(other.alloc)) {
+    if (other.size == 0)
+      return;
+
+    // one free slot at each end, the first element at the beginning of a block
+    mapSize = (other.size + BlockSize - 1) / BlockSize + 2;
+    map = map_allocator_traits::allocate(mapAlloc, mapSize + 1);
+    for (size_t i = 0; i <= mapSize; ++i)
+      map[i] = nullptr;
+    start = BlockSize;
+
+    if constexpr (std::is_trivially_copyable<T>::value)
+      other.ForEachSegment([&](std::span<T const> segment) {
+        T const* source = segment.data();
+        size_t rest = segment.size();
+        while (rest > 0) {
+          size_t pos = start + size;
+          T*& block = map[pos / BlockSize];
+          if (block == nullptr)
+            block = AcquireBlock();
+          size_t part = BlockSize - (pos & blockMask) < rest ? BlockSize - (pos & blockMask) : rest;
+          std::memcpy(static_cast<void*>(block + (pos & blockMask)), source, part * sizeof(T));
+          size += part;
+          source += part;
+          rest -= part;
+        }
+      });
+    else
+      for (auto const& value : other)
+        EmplaceBack(value);
+  }
+
+  /**
+   * @brief Move constructor
+   * @param[in] other deque to move
+   */
+  block_deque_t(block_deque_t&& other) noexcept
+    : map(other.map), mapSize(other.mapSize), start(other.start), size(other.size), spare(other.spare),
+    alloc(std::move(other.alloc)), mapAlloc(std::move(other.mapAlloc)) {
+    other.map = nullptr;
+    other.mapSize = 0;
+    other.start = 0;
+    other.size = 0;
+    other.spare = nullptr;
+  }
+
+  /**
+   * @brief Copy assigment operator
+   * @param[in] other deque to copy
+   * @return reference to this deque
+   */
+  block_deque_t& operator=(block_deque_t const& other) {
+    if (this != &other) {
+      block_deque_t copy(other);
+      Swap(copy);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Move assigment operator
+   * @param[in] other deque to move
+   * @return reference to this deque
+   */
+  block_deque_t& operator=(block_deque_t&& other) noexcept {
+    if (this != &other) {
+      block_deque_t moved(std::move(other));
+      Swap(moved);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Swap contents with other deque
+   * @param[in] other deque to swap with
+   */
+  void Swap(block_deque_t& other) noexcept {
+    std::swap(map, other.map);
+    std::swap(mapSize, other.mapSize);
+    std::swap(start, other.start);
+    std::swap(size, other.size);
+    std::swap(spare, other.spare);
+    std::swap(alloc, other.alloc);
+    std::swap(mapAlloc, other.mapAlloc);
+  }
+
+  /**
+   * @brief Check is deque empty method
+   * @return true if deque is empty, false otherwise
+   */
+  bool IsEmpty() const {
+    return size == 0;
+  }
+
+  /**
+   * @brief Get deque size method
+   * @return number of elements in the deque
+   */
+  size_t Size() const {
+    return size;
+  }
+
+  /**
+   * @brief Subscript operator
+   * @param[in] i index of the element
+   * @return reference to the element
+   * @warning index is not checked
+   */
+  T& operator[](size_t i) {
+    return map[(start + i) / BlockSize][(start + i) & blockMask];
+  }
+
+  /**
+   * @brief Subscript operator
+   * @param[in] i index of the element
+   * @return const reference to the element
+   * @warning index is not checked
+   */
+  T const& operator[](size_t i) const {
+    return map[(start + i) / BlockSize][(start + i) & blockMask];
+  }
+
+  /**
+   * @brief Get element with bounds checking
+   * @param[in] i index of the element
+   * @return reference to the element
+   * @throw std::out_of_range if index is not less than size
+   */
+  T& At(size_t i) {
+    if (i >= size)
+      throw std::out_of_range("deque index out of range");
+    return (*this)[i];
+  }
+
+  /**
+   * @brief Get element with bounds checking
+   * @param[in] i index of the element
+   * @return const reference to the element
+   * @throw std::out_of_range if index is not less than size
+   */
+  T const& At(size_t i) const {
+    if (i >= size)
+      throw std::out_of_range("deque index out of range");
+    return (*this)[i];
+  }
+
+  /**
+   * @brief Get the first element
+   * @return reference to the first element
+   * @warning deque must not be empty
+   */
+  T& Front() {
+    return (*this)[0];
+  }
+
+  /**
+   * @brief Get the first element
+   * @return const reference to the first element
+   * @warning deque must not be empty
+   */
+  T const& Front() const {
+    return (*this)[0];
+  }
+
+  /**
+   * @brief Get the last element
+   * @return reference to the last element
+   * @warning deque must not be empty
+   */
+  T& Back() {
+    return (*this)[size - 1];
+  }
+
+  /**
+   * @brief Get the last element
+   * @return const reference to the last element
+   * @warning deque must not be empty
+   */
+  T const& Back() const {
+    return (*this)[size - 1];
+  }
+
+  /**
+   * @brief Construct element in place at the end of deque
+   * @param[in] args arguments for the element constructor
+   */
+  template <typename... Args>
+  void EmplaceBack(Args&&... args) {
+    size_t pos = start + size;
+    if (pos == mapSize * BlockSize) {
+      GrowMap(false);
+      pos = start + size;
+    }
+
+    T*& block = map[pos / BlockSize];
+    bool isNewBlock = block == nullptr;
+    if (isNewBlock)
+      block = AcquireBlock();
+
+    try {
+      alloc_traits::construct(alloc, block + (pos & blockMask), std::forward<Args>(args)...);
+    }
+    catch (...) {
+      if (isNewBlock) {
+        ReleaseBlock(block);
+        block = nullptr;
+      }
+      throw;
+    }
+    ++size;
+  }
+
+  /**
+   * @brief Construct element in place at the begin of deque
+   * @param[in] args arguments for the element constructor
+   */
+  template <typename... Args>
+  void EmplaceFront(Args&&... args) {
+    if (start == 0)
+      GrowMap(true);
+
+    size_t pos = start - 1;
+    T*& block = map[pos / BlockSize];
+    bool isNewBlock = block == nullptr;
+    if (isNewBlock)
+      block = AcquireBlock();
+
+    try {
+      alloc_traits::construct(alloc, block + (pos & blockMask), std::forward<Args>(args)...);
+    }
+    catch (...) {
+      if (isNewBlock) {
+        ReleaseBlock(block);
+        block = nullptr;
+      }
+      throw;
+    }
+    start = pos;
+    ++size;
+  }
+
+  /**
+   * @brief Method put element to end of deque
+   * @param[in] value element to add
+   */
+  void PushBack(T const& value) {
+    EmplaceBack(value);
+  }
+
+  /**
+   * @brief Method put element to end of deque
+   * @param[in] value element to move
+   */
+  void PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+  }
+
+  /**
+   * @brief Method put element to begin of deque
+   * @param[in] value element to add
+   */
+  void PushFront(T const& value) {
+    EmplaceFront(value);
+  }
+
+  /**
+   * @brief Method put element to begin of deque
+   * @param[in] value element to move
+   */
+  void PushFront(T&& value) {
+    EmplaceFront(std::move(value));
+  }
+
+  /**
+   * @brief Remove element from the back of deque
+   */
+  void PopBack() {
+    if (size == 0)
+      return;
+
+    size_t pos = start + size - 1;
+    T*& block = map[pos / BlockSize];
+    alloc_traits::destroy(alloc, block + (pos & blockMask));
+    --size;
+
+    if ((pos & blockMask) == 0 || size == 0) {
+      ReleaseBlock(block);
+      block = nullptr;
+    }
+    if (size == 0)
+      Recenter();
+  }
+
+  /**
+   * @brief Remove element from the front of deque
+   */
+  void PopFront() {
+    if (size == 0)
+      return;
+
+    T*& block = map[start / BlockSize];
+    alloc_traits::destroy(alloc, block + (start & blockMask));
+    ++start;
+    --size;
+
+    if ((start & blockMask) == 0 || size == 0) {
+      ReleaseBlock(block);
+      block = nullptr;
+    }
+    if (size == 0)
+      Recenter();
+  }
+
+  using iterator = common_iterator<false>;
+  using const_iterator = common_iterator<true>;
+
+  /*
+   * @brief Begin of deque
+   * @return iterator pointed to the first element of deque
+   */
+  iterator begin() {
+    return map == nullptr ? iterator() : iterator(map + start / BlockSize, start & blockMask);
+  }
+
+  /*
+   * @brief End of deque
+   * @return iterator pointed to the next after last element of deque
+   */
+  iterator end() {
+    size_t pos = start + size;
+    return map == nullptr ? iterator() : iterator(map + pos / BlockSize, pos & blockMask);
+  }
+
+  /*
+   * @brief Begin of deque
+   * @return const iterator pointed to the first element of deque
+   */
+  const_iterator begin() const {
+    return cbegin();
+  }
+
+  /*
+   * @brief End of deque
+   * @return const iterator pointed to the next after last element of deque
+   */
+  const_iterator end() const {
+    return cend();
+  }
+
+  std::reverse_iterator<iterator> rbegin() {
+    return std::reverse_iterator<iterator>(end());
+  }
+
+  std::reverse_iterator<iterator> rend() {
+    return std::reverse_iterator<iterator>(begin());
+  }
+
+  /*
+   * @brief Begin of deque
+   * @return const iterator pointed to the first element of deque
+   */
+  const_iterator cbegin() const noexcept {
+    return map == nullptr ? const_iterator() : const_iterator(map + start / BlockSize, start & blockMask);
+  }
+
+  /*
+   * @brief End of deque
+   * @return const iterator pointed to the next after last element of deque
+   * @warning dereferencing can cause undefined behaviour
+   */
+  const_iterator cend() const noexcept {
+    size_t pos = start + size;
+    return map == nullptr ? const_iterator() : const_iterator(map + pos / BlockSize, pos & blockMask);
+  }
+
+  /**
+   * @brief Call function for every contiguous part of deque
+   *
+   * Parts are the used ranges of blocks in order from the first element to the last one,
+   * so loops over them can be vectorized.
+   *
+   * @param[in] fn function called with std::span<T> of each part
+   */
+  template <typename Fn>
+  void ForEachSegment(Fn&& fn) {
+    ForEachSegment(0, size, fn);
+  }
+
+  /**
+   * @brief Call function for every contiguous part of deque
+   * @param[in] fn function called with std::span<T const> of each part
+   */
+  template <typename Fn>
+  void ForEachSegment(Fn&& fn) const {
+    ForEachSegment(0, size, fn);
+  }
+
+  /**
+   * @brief Call function for every contiguous part of range of elements
+   * @param[in] pos index of the first element of the range
+   * @param[in] count number of elements in the range
+   * @param[in] fn function called with std::span<T> of each part
+   * @warning the range is not checked
+   */
+  template <typename Fn>
+  void ForEachSegment(size_t pos, size_t count, Fn&& fn) {
+    for (size_t cur = start + pos, last = start + pos + count; cur != last;) {
+      size_t offset = cur & blockMask;
+      size_t part = BlockSize - offset < last - cur ? BlockSize - offset : last - cur;
+      fn(std::span<T>(map[cur / BlockSize] + offset, part));
+      cur += part;
+    }
+  }
+
+  /**
+   * @brief Call function for every contiguous part of range of elements
+   * @param[in] pos index of the first element of the range
+   * @param[in] count number of elements in the range
+   * @param[in] fn function called with std::span<T const> of each part
+   * @warning the range is not checked
+   */
+  template <typename Fn>
+  void ForEachSegment(size_t pos, size_t count, Fn&& fn) const {
+    for (size_t cur = start + pos, last = start + pos + count; cur != last;) {
+      size_t offset = cur & blockMask;
+      size_t part = BlockSize - offset < last - cur ? BlockSize - offset : last - cur;
+      fn(std::span<T const>(map[cur / BlockSize] + offset, part));
+      cur += part;
+    }
+  }
+
+  /**
+   * @brief Clear deque
+   *
+   * The map is kept, so the deque can be refilled without reallocating it.
+   */
+  void Clear() {
+    if (size == 0)
+      return;
+
+    size_t firstSlot = start / BlockSize;
+    size_t lastSlot = (start + size - 1) / BlockSize;
+
+    if (!std::is_trivially_destructible<T>::value)
+      for (size_t pos = start; pos != start + size; ++pos)
+        alloc_traits::destroy(alloc, map[pos / BlockSize] + (pos & blockMask));
+
+    for (size_t slot = firstSlot; slot <= lastSlot; ++slot) {
+      ReleaseBlock(map[slot]);
+      map[slot] = nullptr;
+    }
+
+    size = 0;
+    Recenter();
+  }
+
+  /**
+   * @brief Release the cached spare block, and the map too if the deque is empty
+   */
+  void ShrinkToFit() {
+    if (spare != nullptr) {
+      alloc_traits::deallocate(alloc, spare, BlockSize);
+      spare = nullptr;
+    }
+    if (size == 0 && map != nullptr) {
+      map_allocator_traits::deallocate(mapAlloc, map, mapSize + 1);
+      map = nullptr;
+      mapSize = 0;
+      start = 0;
+    }
+  }
+
+  /**
+   * @brief Deque destructor
+   */
+  ~block_deque_t() {
+    Release();
+  }
+
+private:
+  /**
+   * @brief Destroy all elements and free all memory
+   */
+  void Release() {
+    Clear();
+    ShrinkToFit();
+  }
+};
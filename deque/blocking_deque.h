@@ -0,0 +1,314 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "deque.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Blocking deque class
+ *
+ * Thread-safe wrapper of deque_t with waiting pops, optional capacity limit with blocking
+ * pushes and Close() for shutdown. A waiting thread spins briefly on a lock-free size copy
+ * and then parks on a condition variable (a futex on Linux); pushes and pops notify only if
+ * somebody is parked, so the uncontended path makes no system calls.
+ *
+ * @tparam T type of stored elements
+ * @tparam Allocator the allocator to be used
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class blocking_deque_t {
+private:
+  static constexpr int spinCount = 128;     ///< number of checks before parking
+
+  deque_t<T, Allocator> deque;              ///< stored elements
+  size_t capacity;                          ///< maximum number of elements (0 if unlimited)
+  bool closed;                              ///< true if Close() was called
+  size_t popWaiters;                        ///< number of threads parked in pops
+  size_t pushWaiters;                       ///< number of threads parked in pushes
+  std::atomic<size_t> count;                ///< copy of deque size readable without the lock
+  std::atomic<bool> isClosed;               ///< copy of 'closed' readable without the lock
+
+  std::mutex mutex;                         ///< protects all non-atomic members
+  std::condition_variable notEmpty;         ///< signalled when element is pushed or deque is closed
+  std::condition_variable notFull;          ///< signalled when element is popped or deque is closed
+
+  /**
+   * @brief Hint processor that the thread is spinning
+   */
+  static void CpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#endif
+  }
+
+  /**
+   * @brief Spin until there is an element to pop or deque is closed
+   */
+  void SpinForElement() const {
+    for (int i = 0; i < spinCount && count.load(std::memory_order_relaxed) == 0 && !isClosed.load(std::memory_order_relaxed); ++i)
+      CpuRelax();
+  }
+
+  /**
+   * @brief Spin until there is room to push or deque is closed
+   */
+  void SpinForRoom() const {
+    if (capacity == 0)
+      return;
+    for (int i = 0; i < spinCount && count.load(std::memory_order_relaxed) >= capacity && !isClosed.load(std::memory_order_relaxed); ++i)
+      CpuRelax();
+  }
+
+  /**
+   * @brief Check whether element can be pushed now
+   * @return true if deque is not full
+   */
+  bool HasRoom() const {
+    return capacity == 0 || deque.Size() < capacity;
+  }
+
+  /**
+   * @brief Put element to deque under the lock and wake a parked pop
+   * @param[in] lock held lock
+   * @param[in] value element to add
+   * @param[in] atBack true to add to the end, false to add to the begin
+   */
+  template <typename U>
+  void PushLocked(std::unique_lock<std::mutex>& lock, U&& value, bool atBack) {
+    if (atBack)
+      deque.PushBack(std::forward<U>(value));
+    else
+      deque.PushFront(std::forward<U>(value));
+    count.store(deque.Size(), std::memory_order_relaxed);
+
+    bool wake = popWaiters != 0;
+    lock.unlock();
+    if (wake)
+      notEmpty.notify_one();
+  }
+
+  /**
+   * @brief Take element from deque under the lock and wake a parked push
+   * @param[in] lock held lock
+   * @param[out] value where to move the removed element
+   */
+  void PopLocked(std::unique_lock<std::mutex>& lock, T& value) {
+    deque.PopFrontN(1, &value);
+    count.store(deque.Size(), std::memory_order_relaxed);
+
+    bool wake = pushWaiters != 0;
+    lock.unlock();
+    if (wake)
+      notFull.notify_one();
+  }
+
+  /**
+   * @brief Put element to end of deque waiting for room
+   * @param[in] value element to add
+   * @return false if the deque is closed, true otherwise
+   */
+  template <typename U>
+  bool PushBackWaiting(U&& value) {
+    SpinForRoom();
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!HasRoom() && !closed) {
+      ++pushWaiters;
+      notFull.wait(lock, [this] { return HasRoom() || closed; });
+      --pushWaiters;
+    }
+    if (closed)
+      return false;
+
+    PushLocked(lock, std::forward<U>(value), true);
+    return true;
+  }
+
+  /**
+   * @brief Put element to deque if there is room
+   * @param[in] value element to add
+   * @param[in] atBack true to add to the end, false to add to the begin
+   * @return false if the deque is full or closed, true otherwise
+   */
+  template <typename U>
+  bool TryPush(U&& value, bool atBack) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (closed || !HasRoom())
+      return false;
+
+    PushLocked(lock, std::forward<U>(value), atBack);
+    return true;
+  }
+
+public:
+  /**
+   * @brief Constructor of empty deque
+   * @param[in] capacity maximum number of elements (0 if unlimited)
+   * @param[in] alloc allocator to use in deque
+   */
+  blocking_deque_t(size_t capacity = 0, Allocator const& alloc = Allocator())
+    : deque(alloc), capacity(capacity), closed(false), popWaiters(0), pushWaiters(0), count(0), isClosed(false) {};
+
+  blocking_deque_t(blocking_deque_t const&) = delete;
+  blocking_deque_t& operator=(blocking_deque_t const&) = delete;
+
+  /**
+   * @brief Get deque size method
+   * @return number of elements at the moment of the check
+   */
+  size_t Size() const {
+    return count.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Check is deque empty method
+   * @return true if deque was empty at the moment of the check, false otherwise
+   */
+  bool IsEmpty() const {
+    return Size() == 0;
+  }
+
+  /**
+   * @brief Check is deque closed method
+   * @return true if Close() was called
+   */
+  bool IsClosed() const {
+    return isClosed.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Put element to end of deque, waiting while deque is full
+   * @param[in] value element to add
+   * @return false if the deque is closed, true otherwise
+   */
+  bool PushBackOrBlock(T const& value) {
+    return PushBackWaiting(value);
+  }
+
+  /**
+   * @brief Put element to end of deque, waiting while deque is full
+   * @param[in] value element to move
+   * @return false if the deque is closed, true otherwise
+   */
+  bool PushBackOrBlock(T&& value) {
+    return PushBackWaiting(std::move(value));
+  }
+
+  /**
+   * @brief Put element to end of deque without waiting
+   * @param[in] value element to add
+   * @return false if the deque is full or closed, true otherwise
+   */
+  bool TryPushBack(T const& value) {
+    return TryPush(value, true);
+  }
+
+  /**
+   * @brief Put element to end of deque without waiting
+   * @param[in] value element to move
+   * @return false if the deque is full or closed, true otherwise
+   */
+  bool TryPushBack(T&& value) {
+    return TryPush(std::move(value), true);
+  }
+
+  /**
+   * @brief Put element to begin of deque without waiting
+   * @param[in] value element to add
+   * @return false if the deque is full or closed, true otherwise
+   */
+  bool TryPushFront(T const& value) {
+    return TryPush(value, false);
+  }
+
+  /**
+   * @brief Put element to begin of deque without waiting
+   * @param[in] value element to move
+   * @return false if the deque is full or closed, true otherwise
+   */
+  bool TryPushFront(T&& value) {
+    return TryPush(std::move(value), false);
+  }
+
+  /**
+   * @brief Remove element from the front of deque without waiting
+   * @param[out] value where to move the removed element
+   * @return false if the deque is empty, true otherwise
+   */
+  bool TryPopFront(T& value) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (deque.IsEmpty())
+      return false;
+
+    PopLocked(lock, value);
+    return true;
+  }
+
+  /**
+   * @brief Remove element from the front of deque, waiting while deque is empty
+   * @param[out] value where to move the removed element
+   * @return false if the deque is closed and empty, true otherwise
+   */
+  bool WaitPopFront(T& value) {
+    SpinForElement();
+    std::unique_lock<std::mutex> lock(mutex);
+    if (deque.IsEmpty() && !closed) {
+      ++popWaiters;
+      notEmpty.wait(lock, [this] { return !deque.IsEmpty() || closed; });
+      --popWaiters;
+    }
+    if (deque.IsEmpty())
+      return false;
+
+    PopLocked(lock, value);
+    return true;
+  }
+
+  /**
+   * @brief Remove element from the front of deque, waiting while deque is empty
+   * @param[out] value where to move the removed element
+   * @param[in] timeout maximum time to wait
+   * @return false if the timeout expired or the deque is closed and empty, true otherwise
+   */
+  template <typename Rep, typename Period>
+  bool WaitPopFront(T& value, std::chrono::duration<Rep, Period> const& timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    SpinForElement();
+    std::unique_lock<std::mutex> lock(mutex);
+    if (deque.IsEmpty() && !closed) {
+      ++popWaiters;
+      notEmpty.wait_until(lock, deadline, [this] { return !deque.IsEmpty() || closed; });
+      --popWaiters;
+    }
+    if (deque.IsEmpty())
+      return false;
+
+    PopLocked(lock, value);
+    return true;
+  }
+
+  /**
+   * @brief Close deque
+   *
+   * Pushes fail after closing, pops return the remaining elements and then fail.
+   * All parked threads are woken up.
+   */
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      closed = true;
+      isClosed.store(true, std::memory_order_relaxed);
+    }
+    notEmpty.notify_all();
+    notFull.notify_all();
+  }
+};
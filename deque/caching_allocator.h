@@ -0,0 +1,435 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(DEQUE_NUMA)
+#include <numa.h>
+#include <sched.h>
+#endif
+
+/**
+ * @brief Source of chunks for caching_heap_t using global operator new
+ */
+struct system_chunk_source {
+  /**
+   * @brief Allocate chunk
+   * @param[in] bytes size of the chunk
+   * @return pointer to memory aligned at least to alignof(std::max_align_t)
+   */
+  static void* Allocate(size_t bytes) {
+    return ::operator new(bytes);
+  }
+
+  /**
+   * @brief Get number of memory nodes
+   * @return 1
+   */
+  static size_t NodeCount() {
+    return 1;
+  }
+
+  /**
+   * @brief Get memory node of the calling thread
+   * @return 0
+   */
+  static size_t CurrentNode() {
+    return 0;
+  }
+};
+
+/**
+ * @brief Source of chunks for caching_heap_t allocating on the NUMA node of the calling thread
+ *
+ * Uses libnuma when compiled with DEQUE_NUMA (CMake option DEQUE_ENABLE_NUMA) and NUMA is
+ * available at run time, otherwise behaves as system_chunk_source.
+ */
+struct numa_chunk_source {
+  /**
+   * @brief Allocate chunk on the local node
+   * @param[in] bytes size of the chunk
+   * @return pointer to memory aligned at least to alignof(std::max_align_t)
+   */
+  static void* Allocate(size_t bytes) {
+#if defined(DEQUE_NUMA)
+    if (numa_available() >= 0) {
+      void* chunk = numa_alloc_local(bytes);
+      if (chunk == nullptr)
+        throw std::bad_alloc();
+      return chunk;
+    }
+#endif
+    return ::operator new(bytes);
+  }
+
+  /**
+   * @brief Get number of memory nodes
+   * @return number of NUMA nodes (1 without NUMA)
+   */
+  static size_t NodeCount() {
+#if defined(DEQUE_NUMA)
+    if (numa_available() >= 0)
+      return (size_t)(numa_max_node() + 1);
+#endif
+    return 1;
+  }
+
+  /**
+   * @brief Get memory node of the calling thread
+   *
+   * Called once per thread, when its cache is created.
+   *
+   * @return NUMA node of the CPU the thread runs on (0 without NUMA)
+   */
+  static size_t CurrentNode() {
+#if defined(DEQUE_NUMA)
+    if (numa_available() >= 0) {
+      // libnuma fills its cpu-to-node table lazily without locking
+      static std::mutex mutex;
+      std::lock_guard<std::mutex> lock(mutex);
+      int cpu = sched_getcpu();
+      int node = cpu < 0 ? 0 : numa_node_of_cpu(cpu);
+      return node < 0 ? 0 : (size_t)node;
+    }
+#endif
+    return 0;
+  }
+};
+
+/**
+ * @brief Heap of small slots with per-thread caches
+ *
+ * Every thread keeps two magazines (lists of up to 'magazineSize' free slots) per size class
+ * and allocates and frees without locks while they last. Full magazines are exchanged
+ * with a depot under a mutex once per 'magazineSize' operations; the depot carves new
+ * slots out of chunks taken from 'Source'. A slot freed by another thread goes to the cache
+ * of the freeing thread and returns to the depot when that cache overflows.
+ * Every memory node has its own depot, a thread uses the depot of the node it started on.
+ * Chunks are never returned to 'Source', the heap only recycles them.
+ *
+ * @tparam Source source of chunks (system_chunk_source or numa_chunk_source)
+ */
+template <typename Source>
+class caching_heap_t {
+public:
+  static constexpr size_t granularity = 16;         ///< size class step in bytes
+  static constexpr size_t sizeClasses = 16;         ///< number of size classes (slots up to 256 bytes)
+  static constexpr size_t magazineSize = 64;        ///< number of slots in a full magazine
+  static constexpr size_t chunkBytes = 64 * 1024;   ///< size of chunks taken from the source
+
+private:
+  /**
+   * @brief Free slot class
+   */
+  struct slot_t {
+    slot_t* next;             ///< next free slot in the magazine or the loose list
+    slot_t* nextMagazine;     ///< next full magazine in the depot (valid in the first slot of a magazine)
+  };
+
+  /**
+   * @brief Magazine class
+   */
+  struct magazine_t {
+    slot_t* head = nullptr;   ///< first free slot (linked by 'next')
+    size_t count = 0;         ///< number of slots
+  };
+
+  /**
+   * @brief Depot of a memory node
+   */
+  struct depot_t {
+    std::mutex mutex;                     ///< protects the lists
+    slot_t* full[sizeClasses] = {};       ///< full magazines by size class (linked by 'nextMagazine')
+    slot_t* loose[sizeClasses] = {};      ///< free slots not in magazines by size class (linked by 'next')
+  };
+
+  /**
+   * @brief Cache of a thread
+   */
+  struct thread_cache_t {
+    depot_t* depot;                       ///< depot of the node of the thread
+    magazine_t loaded[sizeClasses];       ///< magazines slots are taken from and put to
+    magazine_t previous[sizeClasses];     ///< spare magazines, either empty or full
+
+    /**
+     * @brief Constructor of empty cache
+     */
+    thread_cache_t() : depot(&Depot(Source::CurrentNode())) {};
+
+    /**
+     * @brief Cache destructor, returns the cached slots to the depot
+     */
+    ~thread_cache_t() {
+      for (size_t sizeClass = 0; sizeClass < sizeClasses; ++sizeClass) {
+        ReturnLoose(*depot, sizeClass, loaded[sizeClass]);
+        ReturnLoose(*depot, sizeClass, previous[sizeClass]);
+      }
+      cacheDestroyed = true;
+    }
+  };
+
+  static inline thread_local bool cacheDestroyed = false;   ///< the cache of the thread is already destroyed (thread exit)
+
+  /**
+   * @brief Get depot of memory node
+   *
+   * Depots are never destroyed, so caches of threads exiting late can still return slots.
+   *
+   * @param[in] node memory node
+   * @return reference to the depot
+   */
+  static depot_t& Depot(size_t node) {
+    static size_t const count = Source::NodeCount();
+    static depot_t* const depots = new depot_t[count];
+    return depots[node < count ? node : 0];
+  }
+
+  /**
+   * @brief Get cache of the calling thread
+   * @return pointer to the cache (nullptr if the thread is exiting and the cache is destroyed)
+   */
+  static thread_cache_t* Cache() {
+    if (cacheDestroyed)
+      return nullptr;
+    thread_local thread_cache_t cache;
+    return &cache;
+  }
+
+  /**
+   * @brief Take magazine from depot, carving new chunk if the depot is empty
+   * @param[in] depot depot to take from
+   * @param[in] sizeClass size class of the slots
+   * @return non-empty magazine (full unless taken from loose slots)
+   */
+  static magazine_t Fetch(depot_t& depot, size_t sizeClass) {
+    std::lock_guard<std::mutex> lock(depot.mutex);
+    magazine_t magazine;
+    if (slot_t* head = depot.full[sizeClass]) {
+      depot.full[sizeClass] = head->nextMagazine;
+      magazine.head = head;
+      magazine.count = magazineSize;
+      return magazine;
+    }
+
+    if (depot.loose[sizeClass] == nullptr) {
+      size_t slotBytes = (sizeClass + 1) * granularity;
+      char* chunk = static_cast<char*>(Source::Allocate(chunkBytes));
+      for (size_t i = chunkBytes / slotBytes; i-- > 0;) {
+        slot_t* slot = reinterpret_cast<slot_t*>(chunk + i * slotBytes);
+        slot->next = depot.loose[sizeClass];
+        depot.loose[sizeClass] = slot;
+      }
+    }
+
+    slot_t* head = depot.loose[sizeClass];
+    slot_t* tail = head;
+    magazine.count = 1;
+    for (; magazine.count < magazineSize && tail->next != nullptr; ++magazine.count)
+      tail = tail->next;
+    depot.loose[sizeClass] = tail->next;
+    tail->next = nullptr;
+    magazine.head = head;
+    return magazine;
+  }
+
+  /**
+   * @brief Put full magazine to depot
+   * @param[in] depot depot to put to
+   * @param[in] sizeClass size class of the slots
+   * @param[in] magazine magazine with 'magazineSize' slots
+   */
+  static void PutFull(depot_t& depot, size_t sizeClass, magazine_t const& magazine) {
+    std::lock_guard<std::mutex> lock(depot.mutex);
+    magazine.head->nextMagazine = depot.full[sizeClass];
+    depot.full[sizeClass] = magazine.head;
+  }
+
+  /**
+   * @brief Put slots of magazine to loose slots of depot
+   * @param[in] depot depot to put to
+   * @param[in] sizeClass size class of the slots
+   * @param[in] magazine magazine with any number of slots
+   */
+  static void ReturnLoose(depot_t& depot, size_t sizeClass, magazine_t const& magazine) {
+    if (magazine.head == nullptr)
+      return;
+
+    slot_t* tail = magazine.head;
+    while (tail->next != nullptr)
+      tail = tail->next;
+
+    std::lock_guard<std::mutex> lock(depot.mutex);
+    tail->next = depot.loose[sizeClass];
+    depot.loose[sizeClass] = magazine.head;
+  }
+
+public:
+  /**
+   * @brief Get size class of allocation
+   * @param[in] bytes size of allocation
+   * @return size class (sizeClasses if the allocation is too large for slots)
+   */
+  static constexpr size_t SizeClass(size_t bytes) {
+    size_t index = (bytes + granularity - 1) / granularity;
+    return index == 0 ? 0 : (index <= sizeClasses ? index - 1 : sizeClasses);
+  }
+
+  /**
+   * @brief Allocate slot
+   * @param[in] sizeClass size class of the slot (less than sizeClasses)
+   * @return pointer to memory aligned to 'granularity'
+   */
+  static void* Allocate(size_t sizeClass) {
+    thread_cache_t* cache = Cache();
+    if (cache == nullptr) {
+      // the thread is exiting, go to the depot directly
+      depot_t& depot = Depot(Source::CurrentNode());
+      magazine_t magazine = Fetch(depot, sizeClass);
+      slot_t* slot = magazine.head;
+      ReturnLoose(depot, sizeClass, magazine_t{ slot->next, magazine.count - 1 });
+      return slot;
+    }
+
+    magazine_t& loaded = cache->loaded[sizeClass];
+    if (loaded.head == nullptr) {
+      magazine_t& previous = cache->previous[sizeClass];
+      if (previous.count != 0)
+        std::swap(loaded, previous);
+      else
+        loaded = Fetch(*cache->depot, sizeClass);
+    }
+
+    slot_t* slot = loaded.head;
+    loaded.head = slot->next;
+    --loaded.count;
+    return slot;
+  }
+
+  /**
+   * @brief Free slot
+   * @param[in] pointer pointer returned by Allocate (by any thread)
+   * @param[in] sizeClass size class the slot was allocated with
+   */
+  static void Deallocate(void* pointer, size_t sizeClass) noexcept {
+    slot_t* slot = static_cast<slot_t*>(pointer);
+    thread_cache_t* cache = Cache();
+    if (cache == nullptr) {
+      slot->next = nullptr;
+      ReturnLoose(Depot(Source::CurrentNode()), sizeClass, magazine_t{ slot, 1 });
+      return;
+    }
+
+    magazine_t& loaded = cache->loaded[sizeClass];
+    if (loaded.count == magazineSize) {
+      magazine_t& previous = cache->previous[sizeClass];
+      if (previous.count != 0)
+        PutFull(*cache->depot, sizeClass, previous);
+      previous = loaded;
+      loaded = magazine_t();
+    }
+
+    slot->next = loaded.head;
+    loaded.head = slot;
+    ++loaded.count;
+  }
+};
+
+/**
+ * @brief Allocator with per-thread caches of small slots
+ *
+ * Stateless allocator over caching_heap_t: single objects up to 256 bytes with alignment
+ * up to 16 (e.g. deque_t nodes) come from the per-thread caches, so threads churning their
+ * own deques do not contend on the global heap. Other requests go to operator new.
+ * All instances are equal, so memory may be freed through any of them on any thread.
+ *
+ * @tparam T type of allocated objects
+ * @tparam Source source of chunks (numa_chunk_source keeps chunks on the local NUMA node)
+ */
+template <typename T, typename Source = system_chunk_source>
+class caching_allocator {
+private:
+  using heap_t = caching_heap_t<Source>;
+
+  static constexpr size_t sizeClass = heap_t::SizeClass(sizeof(T));   ///< size class of one object
+  static constexpr bool cached = sizeClass < heap_t::sizeClasses && alignof(T) <= heap_t::granularity;
+  static constexpr bool overAligned = alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  /**
+   * @brief Default constructor
+   */
+  caching_allocator() noexcept = default;
+
+  /**
+   * @brief Rebinding constructor
+   */
+  template <typename U>
+  caching_allocator(caching_allocator<U, Source> const&) noexcept {};
+
+  /**
+   * @brief Allocate memory for objects
+   * @param[in] n number of objects
+   * @return pointer to uninitialized memory
+   */
+  T* allocate(size_t n) {
+    if constexpr (cached)
+      if (n == 1)
+        return static_cast<T*>(heap_t::Allocate(sizeClass));
+
+    if (n > static_cast<size_t>(-1) / sizeof(T))
+      throw std::bad_array_new_length();
+    if constexpr (overAligned)
+      return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    else
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+
+  /**
+   * @brief Free memory
+   * @param[in] pointer pointer returned by allocate
+   * @param[in] n number of objects
+   */
+  void deallocate(T* pointer, size_t n) noexcept {
+    if constexpr (cached)
+      if (n == 1) {
+        heap_t::Deallocate(pointer, sizeClass);
+        return;
+      }
+
+    if constexpr (overAligned)
+      ::operator delete(pointer, std::align_val_t(alignof(T)));
+    else
+      ::operator delete(pointer);
+  }
+
+  /**
+   * @brief Equality operator
+   * @return true
+   */
+  template <typename U>
+  bool operator==(caching_allocator<U, Source> const&) const noexcept {
+    return true;
+  }
+
+  /**
+   * @brief Inequality operator
+   * @return false
+   */
+  template <typename U>
+  bool operator!=(caching_allocator<U, Source> const&) const noexcept {
+    return false;
+  }
+};
+
+/**
+ * @brief Caching allocator taking chunks from the local NUMA node
+ * @tparam T type of allocated objects
+ */
+template <typename T>
+using numa_caching_allocator = caching_allocator<T, numa_chunk_source>;
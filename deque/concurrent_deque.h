@@ -0,0 +1,687 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Lock-free concurrent deque class
+ *
+ * Multi-producer/multi-consumer deque implementing the CAS-based algorithm of M. Michael
+ * ("CAS-based lock-free algorithm for shared deques", 2003). Both ends and the state of an
+ * unfinished push are kept in one 64-bit anchor word, so nodes are addressed by 31-bit
+ * indices instead of pointers. Popped nodes are reclaimed with hazard pointers and reused
+ * by later pushes; node memory is returned to the allocator only by the destructor.
+ *
+ * @tparam T type of stored elements
+ * @tparam Allocator the allocator to be used
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class concurrent_deque_t {
+private:
+  /**
+   * @brief Concurrent deque node class
+   *
+   * 'left' and 'right' are read by other threads while the node is in the deque,
+   * the value is touched only by the pushing and the popping thread.
+   */
+  struct node_t {
+    alignas(T) unsigned char storage[sizeof(T)];    ///< storage for the value
+    std::atomic<uint32_t> left;                     ///< index of the left (front side) neighbour
+    std::atomic<uint32_t> right;                    ///< index of the right (back side) neighbour
+    std::atomic<uint32_t> nextFree;                 ///< index of next node in free or retired list
+
+    /**
+     * @brief Get stored value
+     * @return pointer to the value
+     */
+    T* Value() {
+      return std::launder(reinterpret_cast<T*>(storage));
+    }
+  };
+
+  /**
+   * @brief Hazard pointer record class
+   *
+   * A thread owns a record for the time of one operation.
+   */
+  struct alignas(64) record_t {
+    std::atomic<bool> active;                       ///< true if the record is owned by a thread
+    std::atomic<uint32_t> hazards[3];               ///< indices of nodes the owner is going to read
+    uint32_t retired;                               ///< list of retired nodes linked by 'nextFree'
+    size_t retiredCount;                            ///< number of nodes in the retired list
+  };
+
+  using alloc_traits = std::allocator_traits<Allocator>;  //allocator traits
+  using node_allocator = typename alloc_traits::template rebind_alloc<node_t>;
+  using node_allocator_traits = typename alloc_traits::template rebind_traits<node_t>;
+  using record_allocator = typename alloc_traits::template rebind_alloc<record_t>;
+  using record_allocator_traits = typename alloc_traits::template rebind_traits<record_t>;
+
+  enum : uint64_t {
+    STABLE = 0,               ///< both ends are linked
+    RPUSH = 1,                ///< right end is pushed, but is not linked from its left neighbour yet
+    LPUSH = 2,                ///< left end is pushed, but is not linked from its right neighbour yet
+  };
+
+  static constexpr uint32_t null = 0;                   ///< index meaning no node
+  static constexpr uint32_t maxIndex = (1u << 31) - 1;  ///< largest index fitting in anchor
+  static constexpr unsigned firstChunkBits = 6;         ///< log2 of number of nodes in the first chunk
+  static constexpr unsigned maxChunks = 32;             ///< size of chunk table
+
+  std::atomic<uint64_t> anchor;                     ///< packed left index, right index and status
+  alignas(64) std::atomic<uint64_t> freeList;       ///< head index of free list with ABA tag in high half
+  std::atomic<uint32_t> nextIndex;                  ///< first never used node index
+  uint32_t capacity;                                ///< maximum number of nodes
+  std::atomic<node_t*> chunks[maxChunks];           ///< chunk k holds nodes with indices [2^(k+6) - 63, 2^(k+7) - 63)
+
+  record_t* records;                                ///< hazard pointer records
+  size_t recordCount;                               ///< number of hazard pointer records
+  size_t scanThreshold;                             ///< number of retired nodes triggering reclamation
+
+  Allocator alloc;                                  ///< the allocator for values
+  node_allocator nodeAlloc;                         ///< the allocator for node chunks
+  record_allocator recordAlloc;                     ///< the allocator for hazard records
+
+  /**
+   * @brief Pack anchor
+   * @param[in] left index of the left end
+   * @param[in] right index of the right end
+   * @param[in] status push status
+   * @return packed anchor word
+   */
+  static uint64_t Pack(uint32_t left, uint32_t right, uint64_t status) {
+    return (uint64_t)left | ((uint64_t)right << 31) | (status << 62);
+  }
+
+  /**
+   * @brief Get index of the left end from anchor
+   * @param[in] a anchor word
+   * @return index of the left end (null if deque is empty)
+   */
+  static uint32_t Left(uint64_t a) {
+    return (uint32_t)(a & maxIndex);
+  }
+
+  /**
+   * @brief Get index of the right end from anchor
+   * @param[in] a anchor word
+   * @return index of the right end (null if deque is empty)
+   */
+  static uint32_t Right(uint64_t a) {
+    return (uint32_t)((a >> 31) & maxIndex);
+  }
+
+  /**
+   * @brief Get push status from anchor
+   * @param[in] a anchor word
+   * @return STABLE, RPUSH or LPUSH
+   */
+  static uint64_t Status(uint64_t a) {
+    return a >> 62;
+  }
+
+  /**
+   * @brief Get index of highest set bit
+   * @param[in] value non-zero number
+   * @return position of the highest set bit
+   */
+  static unsigned HighestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - (unsigned)__builtin_clzll(value);
+#elif defined(_MSC_VER)
+    unsigned long bit;
+    _BitScanReverse64(&bit, value);
+    return (unsigned)bit;
+#else
+    unsigned bit = 0;
+    while (value >>= 1)
+      ++bit;
+    return bit;
+#endif
+  }
+
+  /**
+   * @brief Get node by index
+   * @param[in] index index of the node (not null)
+   * @return reference to the node
+   */
+  node_t& Node(uint32_t index) const {
+    uint64_t position = (uint64_t)index + ((1u << firstChunkBits) - 1);
+    unsigned chunk = HighestBit(position) - firstChunkBits;
+    return chunks[chunk].load(std::memory_order_acquire)[position - ((uint64_t)1 << (chunk + firstChunkBits))];
+  }
+
+  /**
+   * @brief Get number of nodes in chunk
+   * @param[in] chunk index of the chunk
+   * @return number of nodes
+   */
+  static size_t ChunkSize(unsigned chunk) {
+    return (size_t)1 << (chunk + firstChunkBits);
+  }
+
+  /**
+   * @brief Take node from the free list
+   * @return index of the node (null if the free list is empty)
+   */
+  uint32_t TakeFreeNode() {
+    uint64_t head = freeList.load();
+    while ((uint32_t)head != null) {
+      uint32_t next = Node((uint32_t)head).nextFree.load();
+      if (freeList.compare_exchange_weak(head, (uint64_t)next | ((head >> 32) + 1) << 32))
+        return (uint32_t)head;
+    }
+    return null;
+  }
+
+  /**
+   * @brief Scan retired lists of all records not owned by other threads
+   *
+   * Used when the capacity is exhausted, as retired nodes of idle records
+   * would otherwise wait for later pops through the same record.
+   */
+  void ReclaimRetired() {
+    for (size_t i = 0; i < recordCount; ++i) {
+      record_t& record = records[i];
+      bool expected = false;
+      if (record.active.load(std::memory_order_relaxed) || !record.active.compare_exchange_strong(expected, true))
+        continue;
+      if (record.retiredCount != 0)
+        Scan(record);
+      ReleaseRecord(record);
+    }
+  }
+
+  /**
+   * @brief Take node from the free list or from the never used ones
+   *
+   * Reclaims retired nodes of all records before reporting exhaustion.
+   *
+   * @return index of the node (null if the capacity is exhausted)
+   */
+  uint32_t AllocateNode() {
+    uint32_t index = TakeFreeNode();
+    if (index != null)
+      return index;
+
+    index = nextIndex.load();
+    do {
+      if (index > capacity) {
+        ReclaimRetired();
+        return TakeFreeNode();
+      }
+    } while (!nextIndex.compare_exchange_weak(index, index + 1));
+
+    uint64_t position = (uint64_t)index + ((1u << firstChunkBits) - 1);
+    unsigned chunk = HighestBit(position) - firstChunkBits;
+    if (chunks[chunk].load(std::memory_order_acquire) == nullptr) {
+      node_t* nodes = node_allocator_traits::allocate(nodeAlloc, ChunkSize(chunk));
+      for (size_t i = 0; i < ChunkSize(chunk); ++i) {
+        ::new (static_cast<void*>(&nodes[i].left)) std::atomic<uint32_t>(null);
+        ::new (static_cast<void*>(&nodes[i].right)) std::atomic<uint32_t>(null);
+        ::new (static_cast<void*>(&nodes[i].nextFree)) std::atomic<uint32_t>(null);
+      }
+
+      node_t* expected = nullptr;
+      if (!chunks[chunk].compare_exchange_strong(expected, nodes, std::memory_order_acq_rel))
+        node_allocator_traits::deallocate(nodeAlloc, nodes, ChunkSize(chunk));
+    }
+    return index;
+  }
+
+  /**
+   * @brief Put node to the free list
+   * @param[in] index index of the node without alive value
+   */
+  void FreeNode(uint32_t index) {
+    node_t& node = Node(index);
+    uint64_t head = freeList.load();
+    do {
+      node.nextFree.store((uint32_t)head);
+    } while (!freeList.compare_exchange_weak(head, (uint64_t)index | ((head >> 32) + 1) << 32));
+  }
+
+  /**
+   * @brief Take hazard pointer record for the current operation
+   * @return reference to the record
+   */
+  record_t& AcquireRecord() {
+    static thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+    for (size_t i = hint;; ++i) {
+      record_t& record = records[i % recordCount];
+      bool expected = false;
+      if (!record.active.load(std::memory_order_relaxed) && record.active.compare_exchange_strong(expected, true)) {
+        hint = i;
+        return record;
+      }
+    }
+  }
+
+  /**
+   * @brief Return hazard pointer record after operation
+   * @param[in] record the record to release
+   */
+  void ReleaseRecord(record_t& record) {
+    for (auto& hazard : record.hazards)
+      hazard.store(null, std::memory_order_release);
+    record.active.store(false, std::memory_order_release);
+  }
+
+  /**
+   * @brief Read anchor and protect its ends with hazard pointers
+   * @param[in] record hazard pointer record of the operation
+   * @return anchor value whose ends can not be reclaimed until the record is changed
+   */
+  uint64_t ProtectAnchor(record_t& record) {
+    uint64_t a = anchor.load();
+    for (;;) {
+      record.hazards[0].store(Left(a));
+      record.hazards[1].store(Right(a));
+      uint64_t check = anchor.load();
+      if (check == a)
+        return a;
+      a = check;
+    }
+  }
+
+  /**
+   * @brief Retire popped node and reclaim nodes no thread is reading
+   * @param[in] record hazard pointer record of the operation
+   * @param[in] index index of the popped node
+   */
+  void Retire(record_t& record, uint32_t index) {
+    Node(index).nextFree.store(record.retired, std::memory_order_relaxed);
+    record.retired = index;
+    if (++record.retiredCount >= scanThreshold)
+      Scan(record);
+  }
+
+  /**
+   * @brief Move not hazardous retired nodes of record to the free list
+   * @param[in] record hazard pointer record of the operation
+   */
+  void Scan(record_t& record) {
+    static thread_local std::vector<uint32_t> hazards;
+    hazards.clear();
+    for (size_t i = 0; i < recordCount; ++i)
+      for (auto& hazard : records[i].hazards) {
+        uint32_t index = hazard.load();
+        if (index != null)
+          hazards.push_back(index);
+      }
+    std::sort(hazards.begin(), hazards.end());
+
+    uint32_t index = record.retired;
+    record.retired = null;
+    record.retiredCount = 0;
+    while (index != null) {
+      uint32_t next = Node(index).nextFree.load(std::memory_order_relaxed);
+      if (std::binary_search(hazards.begin(), hazards.end(), index)) {
+        Node(index).nextFree.store(record.retired, std::memory_order_relaxed);
+        record.retired = index;
+        ++record.retiredCount;
+      }
+      else
+        FreeNode(index);
+      index = next;
+    }
+  }
+
+  /**
+   * @brief Link right end pushed with anchor 'a' from its left neighbour
+   * @param[in] record hazard pointer record protecting ends of 'a'
+   * @param[in] a anchor value with RPUSH status
+   */
+  void StabilizeRight(record_t& record, uint64_t a) {
+    uint32_t right = Right(a);
+    uint32_t prev = Node(right).left.load();
+    record.hazards[2].store(prev);
+    if (anchor.load() != a)
+      return;
+
+    uint32_t prevNext = Node(prev).right.load();
+    if (prevNext != right) {
+      if (anchor.load() != a)
+        return;
+      if (!Node(prev).right.compare_exchange_strong(prevNext, right))
+        return;
+    }
+    anchor.compare_exchange_strong(a, Pack(Left(a), right, STABLE));
+  }
+
+  /**
+   * @brief Link left end pushed with anchor 'a' from its right neighbour
+   * @param[in] record hazard pointer record protecting ends of 'a'
+   * @param[in] a anchor value with LPUSH status
+   */
+  void StabilizeLeft(record_t& record, uint64_t a) {
+    uint32_t left = Left(a);
+    uint32_t prev = Node(left).right.load();
+    record.hazards[2].store(prev);
+    if (anchor.load() != a)
+      return;
+
+    uint32_t prevNext = Node(prev).left.load();
+    if (prevNext != left) {
+      if (anchor.load() != a)
+        return;
+      if (!Node(prev).left.compare_exchange_strong(prevNext, left))
+        return;
+    }
+    anchor.compare_exchange_strong(a, Pack(left, Right(a), STABLE));
+  }
+
+  /**
+   * @brief Finish push of other thread
+   * @param[in] record hazard pointer record protecting ends of 'a'
+   * @param[in] a anchor value with not stable status
+   */
+  void Stabilize(record_t& record, uint64_t a) {
+    if (Status(a) == RPUSH)
+      StabilizeRight(record, a);
+    else
+      StabilizeLeft(record, a);
+  }
+
+  /**
+   * @brief Push constructed node to the end of deque
+   * @param[in] index index of the node
+   */
+  void PushRightNode(uint32_t index) {
+    node_t& node = Node(index);
+    record_t& record = AcquireRecord();
+    node.right.store(null, std::memory_order_relaxed);
+
+    for (;;) {
+      uint64_t a = ProtectAnchor(record);
+      if (Right(a) == null) {
+        if (anchor.compare_exchange_strong(a, Pack(index, index, STABLE)))
+          break;
+      }
+      else if (Status(a) == STABLE) {
+        node.left.store(Right(a), std::memory_order_relaxed);
+        // the old right end stays protected as future left neighbour, the new node before it is published
+        record.hazards[2].store(Right(a));
+        record.hazards[1].store(index);
+        uint64_t pushed = Pack(Left(a), index, RPUSH);
+        if (anchor.compare_exchange_strong(a, pushed)) {
+          StabilizeRight(record, pushed);
+          break;
+        }
+      }
+      else
+        Stabilize(record, a);
+    }
+    ReleaseRecord(record);
+  }
+
+  /**
+   * @brief Push constructed node to the begin of deque
+   * @param[in] index index of the node
+   */
+  void PushLeftNode(uint32_t index) {
+    node_t& node = Node(index);
+    record_t& record = AcquireRecord();
+    node.left.store(null, std::memory_order_relaxed);
+
+    for (;;) {
+      uint64_t a = ProtectAnchor(record);
+      if (Left(a) == null) {
+        if (anchor.compare_exchange_strong(a, Pack(index, index, STABLE)))
+          break;
+      }
+      else if (Status(a) == STABLE) {
+        node.right.store(Left(a), std::memory_order_relaxed);
+        // the old left end stays protected as future right neighbour, the new node before it is published
+        record.hazards[2].store(Left(a));
+        record.hazards[0].store(index);
+        uint64_t pushed = Pack(index, Right(a), LPUSH);
+        if (anchor.compare_exchange_strong(a, pushed)) {
+          StabilizeLeft(record, pushed);
+          break;
+        }
+      }
+      else
+        Stabilize(record, a);
+    }
+    ReleaseRecord(record);
+  }
+
+  /**
+   * @brief Allocate node and construct value in it
+   * @param[in] value value to forward to the constructor
+   * @return index of the node (null if the capacity is exhausted)
+   */
+  template <typename U>
+  uint32_t CreateNode(U&& value) {
+    uint32_t index = AllocateNode();
+    if (index == null)
+      return null;
+
+    try {
+      alloc_traits::construct(alloc, reinterpret_cast<T*>(Node(index).storage), std::forward<U>(value));
+    }
+    catch (...) {
+      FreeNode(index);
+      throw;
+    }
+    return index;
+  }
+
+  /**
+   * @brief Move value out of popped node and retire it
+   * @param[in] record hazard pointer record of the operation
+   * @param[in] index index of the popped node
+   * @param[out] value where to move the value
+   */
+  void TakeValue(record_t& record, uint32_t index, T& value) {
+    T* stored = Node(index).Value();
+    try {
+      value = std::move(*stored);
+    }
+    catch (...) {
+      alloc_traits::destroy(alloc, stored);
+      Retire(record, index);
+      ReleaseRecord(record);
+      throw;
+    }
+    alloc_traits::destroy(alloc, stored);
+    Retire(record, index);
+    ReleaseRecord(record);
+  }
+
+public:
+  /**
+   * @brief Constructor of empty deque
+   * @param[in] capacity maximum number of nodes (at most 2^31 - 1)
+   * @param[in] alloc allocator to use in deque
+   */
+  concurrent_deque_t(size_t capacity = maxIndex, Allocator const& alloc = Allocator())
+    : anchor(Pack(null, null, STABLE)), freeList(null), nextIndex(1),
+    capacity((uint32_t)std::min<size_t>(capacity, maxIndex)),
+    alloc(alloc), nodeAlloc(alloc), recordAlloc(alloc) {
+    for (auto& chunk : chunks)
+      chunk.store(nullptr, std::memory_order_relaxed);
+
+    recordCount = std::max<size_t>(64, 2 * (size_t)std::thread::hardware_concurrency());
+    // a small deque must not wait for more retires than it has nodes
+    scanThreshold = std::max<size_t>(1, std::min<size_t>(2 * 3 * recordCount, this->capacity));
+    records = record_allocator_traits::allocate(recordAlloc, recordCount);
+    for (size_t i = 0; i < recordCount; ++i) {
+      record_t* record = ::new (static_cast<void*>(records + i)) record_t;
+      record->active.store(false, std::memory_order_relaxed);
+      for (auto& hazard : record->hazards)
+        hazard.store(null, std::memory_order_relaxed);
+      record->retired = null;
+      record->retiredCount = 0;
+    }
+  }
+
+  concurrent_deque_t(concurrent_deque_t const&) = delete;
+  concurrent_deque_t& operator=(concurrent_deque_t const&) = delete;
+
+  /**
+   * @brief Check is deque empty method
+   * @return true if deque was empty at the moment of the check, false otherwise
+   */
+  bool IsEmpty() const {
+    return Right(anchor.load()) == null;
+  }
+
+  /**
+   * @brief Put element to end of deque
+   * @param[in] value element to add
+   * @return false if the capacity is exhausted, true otherwise
+   */
+  bool TryPushBack(T const& value) {
+    uint32_t index = CreateNode(value);
+    if (index == null)
+      return false;
+    PushRightNode(index);
+    return true;
+  }
+
+  /**
+   * @brief Put element to end of deque
+   * @param[in] value element to move
+   * @return false if the capacity is exhausted, true otherwise
+   */
+  bool TryPushBack(T&& value) {
+    uint32_t index = CreateNode(std::move(value));
+    if (index == null)
+      return false;
+    PushRightNode(index);
+    return true;
+  }
+
+  /**
+   * @brief Put element to begin of deque
+   * @param[in] value element to add
+   * @return false if the capacity is exhausted, true otherwise
+   */
+  bool TryPushFront(T const& value) {
+    uint32_t index = CreateNode(value);
+    if (index == null)
+      return false;
+    PushLeftNode(index);
+    return true;
+  }
+
+  /**
+   * @brief Put element to begin of deque
+   * @param[in] value element to move
+   * @return false if the capacity is exhausted, true otherwise
+   */
+  bool TryPushFront(T&& value) {
+    uint32_t index = CreateNode(std::move(value));
+    if (index == null)
+      return false;
+    PushLeftNode(index);
+    return true;
+  }
+
+  /**
+   * @brief Remove element from the back of deque
+   * @param[out] value where to move the removed element
+   * @return false if the deque is empty, true otherwise
+   */
+  bool TryPopBack(T& value) {
+    record_t& record = AcquireRecord();
+    uint32_t right;
+
+    for (;;) {
+      uint64_t a = ProtectAnchor(record);
+      right = Right(a);
+      if (right == null) {
+        ReleaseRecord(record);
+        return false;
+      }
+      if (right == Left(a)) {
+        if (anchor.compare_exchange_strong(a, Pack(null, null, STABLE)))
+          break;
+      }
+      else if (Status(a) == STABLE) {
+        uint32_t prev = Node(right).left.load();
+        if (anchor.compare_exchange_strong(a, Pack(Left(a), prev, STABLE)))
+          break;
+      }
+      else
+        Stabilize(record, a);
+    }
+
+    TakeValue(record, right, value);
+    return true;
+  }
+
+  /**
+   * @brief Remove element from the front of deque
+   * @param[out] value where to move the removed element
+   * @return false if the deque is empty, true otherwise
+   */
+  bool TryPopFront(T& value) {
+    record_t& record = AcquireRecord();
+    uint32_t left;
+
+    for (;;) {
+      uint64_t a = ProtectAnchor(record);
+      left = Left(a);
+      if (left == null) {
+        ReleaseRecord(record);
+        return false;
+      }
+      if (left == Right(a)) {
+        if (anchor.compare_exchange_strong(a, Pack(null, null, STABLE)))
+          break;
+      }
+      else if (Status(a) == STABLE) {
+        uint32_t prev = Node(left).right.load();
+        if (anchor.compare_exchange_strong(a, Pack(prev, Right(a), STABLE)))
+          break;
+      }
+      else
+        Stabilize(record, a);
+    }
+
+    TakeValue(record, left, value);
+    return true;
+  }
+
+  /**
+   * @brief Deque destructor
+   * @warning no other thread may use the deque during destruction
+   */
+  ~concurrent_deque_t() {
+    uint64_t a = anchor.load();
+    if (Status(a) != STABLE) {
+      record_t& record = AcquireRecord();
+      Stabilize(record, ProtectAnchor(record));
+      ReleaseRecord(record);
+      a = anchor.load();
+    }
+
+    if (!std::is_trivially_destructible<T>::value && Left(a) != null)
+      for (uint32_t index = Left(a);; index = Node(index).right.load()) {
+        alloc_traits::destroy(alloc, Node(index).Value());
+        if (index == Right(a))
+          break;
+      }
+
+    for (unsigned chunk = 0; chunk < maxChunks; ++chunk)
+      if (node_t* nodes = chunks[chunk].load())
+        node_allocator_traits::deallocate(nodeAlloc, nodes, ChunkSize(chunk));
+    record_allocator_traits::deallocate(recordAlloc, records, recordCount);
+  }
+};
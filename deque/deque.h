@@ -3,90 +3,128 @@
 #include <iostream>
 #include <stdexcept>
 #include <exception>
+#include <initializer_list>
+#include <iterator>
 #include <memory>
+#include <optional>
 #include <type_traits>
+#include <utility>
+
+#include "deque_stats.h"
+
+/**
+ * @brief Check whether allocator memory is reclaimed all at once
+ *
+ * Allocators declaring 'is_resettable' as std::true_type (e.g. arena_allocator) let
+ * containers skip per-node deallocation on request (see deque_t::ClearForArenaReset).
+ *
+ * @tparam Allocator allocator to check
+ */
+template <typename Allocator, typename = void>
+struct is_resettable_allocator : std::false_type {};
+
+template <typename Allocator>
+struct is_resettable_allocator<Allocator, std::void_t<typename Allocator::is_resettable>> : Allocator::is_resettable {};
 
 /**
  * @brief Deque class
+ *
+ * Circular doubly linked list with a sentinel embedded in the deque: the sentinel
+ * precedes the first node and follows the last one, so every node always has both
+ * neighbours and pushes and pops are plain pointer rewiring without empty-deque checks.
+ *
  * @tparam T type of stored elements
  * @tparam allocator the allocator to be used
+ * @tparam StatsPolicy statistics to collect (deque_stats_off, deque_stats_on or deque_stats_sampled)
+ *   or deque_policy bundle selecting another storage (see deque_policy.h)
  */
-template <typename T, typename Allocator = std::allocator<T>>
+template <typename T, typename Allocator = std::allocator<T>, typename StatsPolicy = deque_stats_off>
 class deque_t {
 private:
+  /**
+   * @brief Deque link class
+   *
+   * The part of node shared with the sentinel
+   */
+  class link_t {
+  public:
+    link_t* prev;             ///< pointer to previous node (the sentinel if the node is the first)
+    link_t* next;             ///< pointer to next node (the sentinel if the node is the last)
+  };
+
   /**
    * @brief Deque node class
    *
    * The class node storing the value of the specified 'T' type
    */
-  class node_t {
+  class node_t : public link_t {
   public:
     T data;                   ///< stored value
-    node_t* prev;             ///< pointer to previous element (nullptr if the node is the first)
-    node_t* next;             ///< pointer to next element (nullptr if the node is the last)
   };
 
 private:
-  node_t* head;               ///< pointer to the beginning of the deque (nullptr if the deque is empty)
-  node_t* tail;               ///< pointer to the end of the deque (nullptr if the deque is empty)
+  link_t sentinel;            ///< 'next' is the first node, 'prev' is the last node (both the sentinel itself if the deque is empty)
   size_t size;                ///< size in elements in the deque
 
+  node_t* freeNodes;          ///< intrusive list (linked by 'next') of retired nodes kept for reuse
+  size_t freeCount;           ///< number of nodes in the free list
+  size_t poolLimit;           ///< maximum number of nodes kept in the free list (0 disables the pool)
+
   /**
    * @brief Deque iterator class
+   *
+   * One word: the link. end() is the sentinel, so stepping back from it needs no special case.
+   *
    * @tparam IsConst const's of this iterator
    */
   template<bool IsConst>
-  class common_iterator : public std::iterator<std::bidirectional_iterator_tag, T> {
+  class common_iterator {
     friend class deque_t;
+    template <bool> friend class common_iterator;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, T const*, T*>;
+    using reference = std::conditional_t<IsConst, T const&, T&>;
 
   private:
-    node_t* data;               ///< pointer to node in deque
-    node_t* head;               ///< pointer to the beginning of the deque (nullptr if the deque is empty)
-    node_t* tail;               ///< pointer to the end of the deque (nullptr if the deque is empty)
+    link_t* data;               ///< pointer to node in deque (the sentinel for end iterator)
   private:
     /**
      * @brief Constructor from pointer to data
      * @param[in] data pointer in deque list
      */
-    common_iterator(node_t* data, node_t* head, node_t* tail) : data(data), head(head), tail(tail) {};
+    explicit common_iterator(link_t* data) : data(data) {};
 
-    /**
-     * @brief Default constructor
-     */
-    common_iterator() = default;
   public:
     /**
-     * @brief Copy constructor
-     * @param[in] other iterator to copy
+     * @brief Default constructor
      */
-    common_iterator(common_iterator const& other) : data(other.data), head(other.head), tail(other.tail) {};
+    common_iterator() : data(nullptr) {};
 
     /**
-     * @brief Copy assignment operator
-     * @param[in] other iterator to copy
-     * @return reference to this iterator
+     * @brief Conversion from non-const iterator
+     * @param[in] other iterator to convert
      */
-    common_iterator& operator=(common_iterator const& other) { 
-      data = other.data;
-      head = other.head;
-      tail = other.tail;
-      return *this;
-    }
+    template <bool WasConst, typename = std::enable_if_t<IsConst && !WasConst>>
+    common_iterator(common_iterator<WasConst> const& other) : data(other.data) {};
 
     /**
      * @brief Dereference operator *
      * @return reference (const reference for const iterator) to the pointed-to element
      */
-    std::conditional_t<IsConst, T const&, T&> operator*() const {
-      return data->data;
+    reference operator*() const {
+      return static_cast<node_t*>(data)->data;
     }
 
     /**
      * @brief Dereference operator ->
      * @return pointer (const pointer for const iterator) to the pointed-to element
      */
-    std::conditional_t<IsConst, T const*, T*> operator->() const {
-      return data;
+    pointer operator->() const {
+      return &static_cast<node_t*>(data)->data;
     }
 
     /**
@@ -94,10 +132,7 @@ private:
      * @return reference to this iterator
      */
     common_iterator& operator++() {
-      if (this == nullptr)
-        data = head;
-      else
-        data = data->next;
+      data = data->next;
       return *this;
     }
 
@@ -105,7 +140,7 @@ private:
      * @brief Postfix increment
      * @return previous value of this iterator
      */
-    common_iterator& operator++(int) {
+    common_iterator operator++(int) {
       common_iterator tmp = *this;
       ++(*this);
       return tmp;
@@ -116,10 +151,7 @@ private:
      * @return reference to this iterator
      */
     common_iterator& operator--() {
-      if (data == nullptr)
-        data = tail;
-      else
-        data = data->prev;
+      data = data->prev;
       return *this;
     }
 
@@ -127,7 +159,7 @@ private:
      * @brief Postfix decrement
      * @return previous value of this iterator
      */
-    common_iterator& operator--(int) {
+    common_iterator operator--(int) {
       common_iterator tmp = *this;
       --(*this);
       return tmp;
@@ -156,60 +188,312 @@ private:
 private:
   using alloc_traits = std::allocator_traits<Allocator>;  //allocator traits
 
-  template <typename T>
   using node_allocator = typename alloc_traits::template rebind_alloc<node_t>;
 
   using node_allocator_traits = typename alloc_traits::template rebind_traits<node_t>;
 
   Allocator alloc;                  ///< the allocator for T
-  node_allocator<T> nodeAlloc;      ///< the allocator for node_t
+  node_allocator nodeAlloc;         ///< the allocator for node_t
+  [[no_unique_address]] StatsPolicy stats;   ///< collected statistics (no storage if off)
+
+  /**
+   * @brief Get node of link
+   * @param[in] link link of the node (must not be the sentinel)
+   * @return pointer to the node
+   */
+  static node_t* AsNode(link_t* link) {
+    return static_cast<node_t*>(link);
+  }
+
+  /**
+   * @brief Get node of link
+   * @param[in] link link of the node (must not be the sentinel)
+   * @return const pointer to the node
+   */
+  static node_t const* AsNode(link_t const* link) {
+    return static_cast<node_t const*>(link);
+  }
+
+  /**
+   * @brief Get sentinel as mutable link
+   * @return pointer to the sentinel
+   */
+  link_t* End() const {
+    return const_cast<link_t*>(&sentinel);
+  }
+
+  /**
+   * @brief Make the list empty without touching the nodes
+   */
+  void ResetLinks() {
+    sentinel.prev = &sentinel;
+    sentinel.next = &sentinel;
+    size = 0;
+  }
+
+  /**
+   * @brief Insert chain of linked nodes before given link
+   * @param[in] pos link to insert before (the sentinel to insert at the end)
+   * @param[in] first first node of the chain
+   * @param[in] last last node of the chain
+   */
+  static void LinkBefore(link_t* pos, link_t* first, link_t* last) {
+    link_t* prev = pos->prev;
+    first->prev = prev;
+    last->next = pos;
+    prev->next = first;
+    pos->prev = last;
+  }
+
+  /**
+   * @brief Take all nodes of other deque, leaving it empty
+   * @param[in] other deque to take nodes from (this deque must be empty)
+   */
+  void TakeLinks(deque_t& other) {
+    if (other.size == 0)
+      return;
+
+    LinkBefore(&sentinel, other.sentinel.next, other.sentinel.prev);
+    size = other.size;
+    other.ResetLinks();
+  }
+
+  /**
+   * @brief Get memory for a node from the free list or the allocator
+   * @return pointer to the node
+   */
+  node_t* AllocateNode() {
+    if (freeNodes == nullptr) {
+      stats.OnAllocate();
+      return node_allocator_traits::allocate(nodeAlloc, 1);
+    }
+
+    node_t* node = freeNodes;
+    freeNodes = AsNode(node->next);
+    --freeCount;
+    return node;
+  }
+
+  /**
+   * @brief Return memory of a node to the free list or the allocator
+   * @param[in] node pointer to the node
+   */
+  void DeallocateNode(node_t* node) {
+    if (freeCount < poolLimit) {
+      node->next = freeNodes;
+      freeNodes = node;
+      ++freeCount;
+    }
+    else {
+      stats.OnDeallocate();
+      node_allocator_traits::deallocate(nodeAlloc, node, 1);
+    }
+  }
+
+  /**
+   * @brief Allocate node and construct its value in place
+   * @param[in] args arguments for the value constructor
+   * @return pointer to the node with unlinked 'prev' and 'next'
+   */
+  template <typename... Args>
+  node_t* CreateNode(Args&&... args) {
+    node_t* node = AllocateNode();
+    try {
+      node_allocator_traits::construct(nodeAlloc, &node->data, std::forward<Args>(args)...);
+    }
+    catch (...) {
+      DeallocateNode(node);
+      throw;
+    }
+    return node;
+  }
+
+  /**
+   * @brief Destroy value of node and free the node
+   * @param[in] node pointer to the node
+   */
+  void DestroyNode(node_t* node) {
+    node_allocator_traits::destroy(nodeAlloc, &node->data);
+    DeallocateNode(node);
+  }
+
+  /**
+   * @brief Destroy values and free nodes of a chain
+   * @param[in] link first node of the chain linked by 'next'
+   * @param[in] last link after the last node to free (nullptr or the sentinel)
+   */
+  void FreeChain(link_t* link, link_t* last) {
+    while (link != last) {
+      link_t* next = link->next;
+      if constexpr (!std::is_trivially_destructible<T>::value)
+        node_allocator_traits::destroy(nodeAlloc, &AsNode(link)->data);
+      DeallocateNode(AsNode(link));
+      link = next;
+    }
+  }
+
+  /**
+   * @brief Build detached chain of nodes from range
+   *
+   * Nodes are linked while constructed, so the deque invariants are not touched per element.
+   * If constructing an element throws, the already built nodes are freed.
+   *
+   * @param[in] first begin of the range
+   * @param[in] last end of the range
+   * @param[out] chainHead first node of the chain (nullptr if the range is empty)
+   * @param[out] chainTail last node of the chain (nullptr if the range is empty)
+   * @return number of nodes in the chain
+   */
+  template <typename InputIt>
+  size_t BuildChain(InputIt first, InputIt last, link_t*& chainHead, link_t*& chainTail) {
+    size_t count = 0;
+    chainHead = nullptr;
+    chainTail = nullptr;
+
+    try {
+      for (; first != last; ++first) {
+        node_t* node = CreateNode(*first);
+        node->prev = chainTail;
+        node->next = nullptr;
+        if (chainTail)
+          chainTail->next = node;
+        else
+          chainHead = node;
+        chainTail = node;
+        ++count;
+      }
+    }
+    catch (...) {
+      FreeChain(chainHead, nullptr);
+      throw;
+    }
+    return count;
+  }
+
+  /**
+   * @brief Unlink and free first nodes of deque
+   * @param[in] rest first node to keep (the sentinel to remove all)
+   * @param[in] count number of nodes before 'rest'
+   */
+  void CutFront(link_t* rest, size_t count) {
+    if (count == 0)
+      return;
+
+    link_t* removed = sentinel.next;
+    rest->prev = &sentinel;
+    sentinel.next = rest;
+    size -= count;
+    stats.OnPopFront(count);
+    FreeChain(removed, rest);
+  }
+
+  template <typename It>
+  using enable_if_iterator = std::enable_if_t<!std::is_integral<It>::value,
+    typename std::iterator_traits<It>::iterator_category>;
 
 public:
   /**
    * @brief Constructor of empty deque
    * @param[in] alloc allocator to use in deque
    */
-  deque_t(Allocator const& alloc = Allocator()) : head(nullptr), tail(nullptr), size(0), alloc(alloc), nodeAlloc(alloc) {};
+  deque_t(Allocator const& alloc = Allocator())
+    : sentinel{&sentinel, &sentinel}, size(0), freeNodes(nullptr), freeCount(0), poolLimit(0), alloc(alloc), nodeAlloc(alloc) {};
+
+  /**
+   * @brief Constructor from range
+   * @param[in] first begin of the range
+   * @param[in] last end of the range
+   * @param[in] alloc allocator to use in deque
+   */
+  template <typename InputIt, typename = enable_if_iterator<InputIt>>
+  deque_t(InputIt first, InputIt last, Allocator const& alloc = Allocator()) : deque_t(alloc) {
+    PushBackRange(first, last);
+  }
+
+  /**
+   * @brief Constructor from initializer list
+   * @param[in] values elements to put to deque
+   * @param[in] alloc allocator to use in deque
+   */
+  deque_t(std::initializer_list<T> values, Allocator const& alloc = Allocator()) : deque_t(values.begin(), values.end(), alloc) {};
 
   /**
    * @briefCopy constructor
    * @param[in] other deque to copy
    */
-  deque_t(deque_t const& deque) {
-    alloc = deque.alloc;
-    nodeAlloc = deque.nodeAlloc;
-    for (auto& d : deque)
-      PushBack(d);
+  deque_t(deque_t const& deque) : deque_t(alloc_traits::select_on_container_copy_construction(deque.alloc)) {
+    link_t* chainHead;
+    link_t* chainTail;
+    size_t count = BuildChain(deque.begin(), deque.end(), chainHead, chainTail);
+    // the pool limit is set after the copy, so a failed copy frees its nodes instead of caching them
+    poolLimit = deque.poolLimit;
+    if (count == 0)
+      return;
+
+    LinkBefore(&sentinel, chainHead, chainTail);
+    size = count;
+    stats.OnSize(size);
   }
 
   /**
    * @briefMove constructor
    * @param[in] other deque to move
    */
-  deque_t(deque_t&& deque) {
-    alloc = deque.alloc;
-    nodeAlloc = deque.nodeAlloc;
-    head = deque.head;
-    tail = deque.tail;
-    size = deque.size;
-
-    deque.head = nullptr;
-    deque.tail = nullptr;
-    deque.size = 0;
+  deque_t(deque_t&& deque)
+    : sentinel{&sentinel, &sentinel}, size(0), freeNodes(nullptr), freeCount(0), poolLimit(deque.poolLimit),
+    alloc(deque.alloc), nodeAlloc(deque.nodeAlloc) {
+    TakeLinks(deque);
   }
 
   /**
    * @briefCopy assigment operator
+   *
+   * Strongly exception-safe: new nodes are built before anything is changed. With equal
+   * allocators and nothrow copy assignable 'T' existing nodes are reused, so only the
+   * missing ones are allocated.
+   *
    * @param[in] other deque to copy
    * @return reference to this deque
    */
   void operator=(deque_t const& deque) {
-    Clear();
+    if (this == &deque)
+      return;
+
+    if (!(nodeAlloc == deque.nodeAlloc)) {
+      deque_t copy(deque);
+      Clear();
+      ShrinkToFit();
+      alloc = deque.alloc;
+      nodeAlloc = deque.nodeAlloc;
+      TakeLinks(copy);
+      return;
+    }
+
+    size_t reused = std::is_nothrow_copy_assignable<T>::value ? (size < deque.size ? size : deque.size) : 0;
+    const_iterator rest = deque.cbegin();
+    std::advance(rest, reused);
 
+    link_t* chainHead;
+    link_t* chainTail;
+    size_t count = BuildChain(rest, deque.cend(), chainHead, chainTail);
+
+    // nothing below throws
     alloc = deque.alloc;
     nodeAlloc = deque.nodeAlloc;
-    for (auto& d : deque)
-      PushBack(d);
+    iterator node = begin();
+    for (const_iterator source = deque.cbegin(); source != rest; ++source, ++node)
+      *node = *source;
+
+    if (node.data != &sentinel) {
+      link_t* kept = node.data->prev;
+      kept->next = &sentinel;
+      sentinel.prev = kept;
+      FreeChain(node.data, &sentinel);
+    }
+    if (count != 0)
+      LinkBefore(&sentinel, chainHead, chainTail);
+    size = deque.size;
+    stats.OnSize(size);
   }
 
   /**
@@ -219,15 +503,46 @@ public:
    */
   void operator=(deque_t&& deque) {
     Clear();
+    if (!(nodeAlloc == deque.nodeAlloc))
+      ShrinkToFit();
     alloc = deque.alloc;
     nodeAlloc = deque.nodeAlloc;
-    head = deque.head;
-    tail = deque.tail;
-    size = deque.size;
+    TakeLinks(deque);
+  }
 
-    deque.head = nullptr;
-    deque.tail = nullptr;
-    deque.size = 0;
+  /**
+   * @brief Replace contents of deque with range
+   *
+   * Values of existing nodes are assigned in place, missing nodes are built
+   * as one chain and redundant ones are freed at once.
+   *
+   * @param[in] first begin of the range
+   * @param[in] last end of the range
+   */
+  template <typename InputIt, typename = enable_if_iterator<InputIt>>
+  void Assign(InputIt first, InputIt last) {
+    link_t* node = sentinel.next;
+    size_t assigned = 0;
+    for (; node != &sentinel && first != last; node = node->next, ++first, ++assigned)
+      AsNode(node)->data = *first;
+
+    if (node != &sentinel) {
+      link_t* kept = node->prev;
+      kept->next = &sentinel;
+      sentinel.prev = kept;
+      size = assigned;
+      FreeChain(node, &sentinel);
+    }
+    else
+      PushBackRange(first, last);
+  }
+
+  /**
+   * @brief Replace contents of deque with initializer list
+   * @param[in] values elements to put to deque
+   */
+  void Assign(std::initializer_list<T> values) {
+    Assign(values.begin(), values.end());
   }
 
   /**
@@ -235,134 +550,601 @@ public:
    * @return true if deque is empty, false otherwise
    */
   bool IsEmpty() const {
-    return head == nullptr;
+    return sentinel.next == &sentinel;
   }
 
   /**
    * @brief Get deque size method
    * @return number of elements in the deque
    */
-  size_t Size() {
+  size_t Size() const {
     return size;
   }
 
+  /**
+   * @brief Get statistics of deque
+   * @return snapshot of the statistics collected by 'StatsPolicy' (all zeros for deque_stats_off)
+   */
+  deque_stats_t Stats() const {
+    return stats.Snapshot();
+  }
+
+  /**
+   * @brief Get the first element
+   * @return reference to the first element
+   * @warning deque must not be empty
+   */
+  T& Front() {
+    return AsNode(sentinel.next)->data;
+  }
+
+  /**
+   * @brief Get the first element
+   * @return const reference to the first element
+   * @warning deque must not be empty
+   */
+  T const& Front() const {
+    return AsNode(sentinel.next)->data;
+  }
+
+  /**
+   * @brief Get the last element
+   * @return reference to the last element
+   * @warning deque must not be empty
+   */
+  T& Back() {
+    return AsNode(sentinel.prev)->data;
+  }
+
+  /**
+   * @brief Get the last element
+   * @return const reference to the last element
+   * @warning deque must not be empty
+   */
+  T const& Back() const {
+    return AsNode(sentinel.prev)->data;
+  }
+
+  /**
+   * @brief Construct element in place at the end of deque
+   * @param[in] args arguments for the element constructor
+   */
+  template <typename... Args>
+  void EmplaceBack(Args&&... args) {
+    auto timer = stats.StartTimer();
+    node_t* newNode = CreateNode(std::forward<Args>(args)...);
+    LinkBefore(&sentinel, newNode, newNode);
+    ++size;
+    stats.StopTimer(timer);
+    stats.OnPushBack(1, size);
+  }
+
+  /**
+   * @brief Construct element in place at the begin of deque
+   * @param[in] args arguments for the element constructor
+   */
+  template <typename... Args>
+  void EmplaceFront(Args&&... args) {
+    auto timer = stats.StartTimer();
+    node_t* newNode = CreateNode(std::forward<Args>(args)...);
+    LinkBefore(sentinel.next, newNode, newNode);
+    ++size;
+    stats.StopTimer(timer);
+    stats.OnPushFront(1, size);
+  }
+
   /**
    * @brief Method put element to end of deque
    * @param[in] value element to add
    */
-  template <typename T>
-  void PushBack(T&& data) {
-    try {
-      node_t* newNode = node_allocator_traits::allocate(nodeAlloc, 1);
-      newNode->data = data;
-      newNode->prev = tail;
-      newNode->next = nullptr;
+  void PushBack(T const& value) {
+    EmplaceBack(value);
+  }
 
-      if (tail)
-        tail->next = newNode;
+  /**
+   * @brief Method put element to end of deque
+   * @param[in] value element to move
+   */
+  void PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+  }
 
-      tail = newNode;
+  /**
+   * @brief Method put element to begin of deque
+   * @param[in] value element to add
+   */
+  void PushFront(T const& value) {
+    EmplaceFront(value);
+  }
 
-      if (head == nullptr)
-        head = tail;
+  /**
+   * @brief Method put element to begin of deque
+   * @param[in] value element to move
+   */
+  void PushFront(T&& value) {
+    EmplaceFront(std::move(value));
+  }
 
-      ++size;
+  /**
+   * @brief Put range of elements to end of deque
+   *
+   * The whole batch is built as one chain and linked to the deque at once.
+   *
+   * @param[in] first begin of the range
+   * @param[in] last end of the range
+   */
+  template <typename InputIt, typename = enable_if_iterator<InputIt>>
+  void PushBackRange(InputIt first, InputIt last) {
+    link_t* chainHead;
+    link_t* chainTail;
+    size_t count = BuildChain(first, last, chainHead, chainTail);
+    if (count == 0)
+      return;
+
+    LinkBefore(&sentinel, chainHead, chainTail);
+    size += count;
+    stats.OnPushBack(count, size);
+  }
+
+  /**
+   * @brief Put range of elements to begin of deque
+   *
+   * The whole batch is built as one chain and linked to the deque at once.
+   * Elements keep their order, so the first element of the range becomes the first one of deque.
+   *
+   * @param[in] first begin of the range
+   * @param[in] last end of the range
+   */
+  template <typename InputIt, typename = enable_if_iterator<InputIt>>
+  void PushFrontRange(InputIt first, InputIt last) {
+    link_t* chainHead;
+    link_t* chainTail;
+    size_t count = BuildChain(first, last, chainHead, chainTail);
+    if (count == 0)
+      return;
+
+    LinkBefore(sentinel.next, chainHead, chainTail);
+    size += count;
+    stats.OnPushFront(count, size);
+  }
+
+  /**
+   * @brief Move elements from the front of deque to output iterator
+   *
+   * The popped nodes are unlinked from the deque at once.
+   * If moving an element throws, the elements moved before it are still removed.
+   *
+   * @param[in] n maximum number of elements to pop
+   * @param[in] out output iterator to move elements to
+   * @return number of popped elements
+   */
+  template <typename OutputIt>
+  size_t PopFrontN(size_t n, OutputIt out) {
+    link_t* node = sentinel.next;
+    size_t count = 0;
+
+    try {
+      for (; node != &sentinel && count < n; node = node->next, ++count)
+        *out++ = std::move(AsNode(node)->data);
     }
-    catch (std::bad_alloc){
+    catch (...) {
+      CutFront(node, count);
       throw;
     }
+
+    CutFront(node, count);
+    return count;
   }
 
   /**
-   * @brief Method put element to begin of deque
-   * @param[in] value element to add
+   * @brief Move all elements of deque to output iterator
+   * @param[in] out output iterator to move elements to
+   * @return number of moved elements
    */
-  template <typename T>
-  void PushFront(T&& data) {
-    try {
-      node_t* newNode = node_allocator_traits::allocate(nodeAlloc, 1);
-      newNode->data = data;
-      newNode->next = head;
-      newNode->prev = nullptr;
+  template <typename OutputIt>
+  size_t DrainTo(OutputIt out) {
+    return PopFrontN(size, out);
+  }
 
-      if (head)
-        head->prev = newNode;
+  /**
+   * @brief Move all elements of other deque to end of this deque
+   *
+   * Nodes are relinked in O(1) if allocators are equal, otherwise elements are moved one by one.
+   *
+   * @param[in] other deque to take elements from (becomes empty)
+   */
+  void SpliceBack(deque_t&& other) {
+    if (&other == this || other.IsEmpty())
+      return;
 
-      head = newNode;
+    if (!(nodeAlloc == other.nodeAlloc)) {
+      for (link_t* node = other.sentinel.next; node != &other.sentinel; node = node->next)
+        EmplaceBack(std::move(AsNode(node)->data));
+      other.Clear();
+      return;
+    }
 
-      if (tail == nullptr)
-        tail = head;
+    LinkBefore(&sentinel, other.sentinel.next, other.sentinel.prev);
+    size += other.size;
+    stats.OnSize(size);
+    other.ResetLinks();
+  }
 
-      ++size;
-    }
-    catch (std::bad_alloc) {
-      throw;
+  /**
+   * @brief Move all elements of other deque to begin of this deque
+   *
+   * Nodes are relinked in O(1) if allocators are equal, otherwise elements are moved one by one.
+   * Elements keep their order, so the first element of other deque becomes the first one of this deque.
+   *
+   * @param[in] other deque to take elements from (becomes empty)
+   */
+  void SpliceFront(deque_t&& other) {
+    if (&other == this || other.IsEmpty())
+      return;
+
+    if (!(nodeAlloc == other.nodeAlloc)) {
+      for (link_t* node = other.sentinel.prev; node != &other.sentinel; node = node->prev)
+        EmplaceFront(std::move(AsNode(node)->data));
+      other.Clear();
+      return;
     }
+
+    LinkBefore(sentinel.next, other.sentinel.next, other.sentinel.prev);
+    size += other.size;
+    stats.OnSize(size);
+    other.ResetLinks();
   }
 
   /**
    * @brief Remove element from the back of deque
    */
   void PopBack() {
-    if (tail == nullptr)
+    if (size == 0)
       return;
 
-    node_t* oldTail = tail;
-    tail = tail->prev;
-    node_allocator_traits::deallocate(nodeAlloc, oldTail, 1);
-
-    if (tail == nullptr)
-      head = nullptr;
-    else
-      tail->next = nullptr;
-
+    link_t* oldTail = sentinel.prev;
+    link_t* newTail = oldTail->prev;
+    newTail->next = &sentinel;
+    sentinel.prev = newTail;
+    DestroyNode(AsNode(oldTail));
     --size;
+    stats.OnPopBack(1);
   }
 
   /**
    * @brief Remove element from the front of deque
    */
   void PopFront() {
-    if (head == nullptr)
+    if (size == 0)
       return;
 
-    node_t* oldHead = head;
-    head = head->next;
-    node_allocator_traits::deallocate(nodeAlloc, oldHead, 1);
-
-    if (head == nullptr)
-      tail = nullptr;
-    else
-      head->prev = nullptr;
-
+    link_t* oldHead = sentinel.next;
+    link_t* newHead = oldHead->next;
+    newHead->prev = &sentinel;
+    sentinel.next = newHead;
+    DestroyNode(AsNode(oldHead));
     --size;
+    stats.OnPopFront(1);
   }
 
   using iterator = common_iterator<false>;
   using const_iterator = common_iterator<true>;
 
+  /**
+   * @brief Handle of node extracted from deque
+   *
+   * Owns the node with its value. Inserting the handle into a deque with equal allocator
+   * relinks the node without allocation; a handle dropped with a node destroys the value
+   * and frees the node.
+   */
+  class node_handle_t {
+    friend class deque_t;
+
+  private:
+    node_t* node;                               ///< owned node (nullptr if the handle is empty)
+    std::optional<node_allocator> nodeAlloc;    ///< allocator of the node (empty if the handle is empty)
+
+    /**
+     * @brief Constructor from node
+     * @param[in] node unlinked node
+     * @param[in] nodeAlloc allocator the node was allocated with
+     */
+    node_handle_t(node_t* node, node_allocator const& nodeAlloc) : node(node), nodeAlloc(nodeAlloc) {};
+
+    /**
+     * @brief Give up the node without freeing it
+     * @return owned node
+     */
+    node_t* Release() {
+      node_t* result = node;
+      node = nullptr;
+      nodeAlloc.reset();
+      return result;
+    }
+
+    /**
+     * @brief Destroy value and free the node if the handle is not empty
+     */
+    void Reset() {
+      if (node == nullptr)
+        return;
+      node_allocator_traits::destroy(*nodeAlloc, &node->data);
+      node_allocator_traits::deallocate(*nodeAlloc, node, 1);
+      Release();
+    }
+
+  public:
+    /**
+     * @brief Constructor of empty handle
+     */
+    node_handle_t() : node(nullptr) {};
+
+    node_handle_t(node_handle_t const&) = delete;
+    node_handle_t& operator=(node_handle_t const&) = delete;
+
+    /**
+     * @brief Move constructor
+     * @param[in] other handle to take the node from (becomes empty)
+     */
+    node_handle_t(node_handle_t&& other) noexcept : node(other.node), nodeAlloc(std::move(other.nodeAlloc)) {
+      other.Release();
+    }
+
+    /**
+     * @brief Move assignment
+     * @param[in] other handle to take the node from (becomes empty)
+     * @return reference to this handle
+     */
+    node_handle_t& operator=(node_handle_t&& other) noexcept {
+      if (this != &other) {
+        Reset();
+        node = other.node;
+        nodeAlloc = std::move(other.nodeAlloc);
+        other.Release();
+      }
+      return *this;
+    }
+
+    /**
+     * @brief Check is handle empty
+     * @return true if the handle owns no node, false otherwise
+     */
+    bool IsEmpty() const {
+      return node == nullptr;
+    }
+
+    /**
+     * @brief Check is handle not empty
+     * @return true if the handle owns a node, false otherwise
+     */
+    explicit operator bool() const {
+      return node != nullptr;
+    }
+
+    /**
+     * @brief Get value of the node
+     * @return reference to the value
+     * @warning handle must not be empty
+     */
+    T& Value() const {
+      return node->data;
+    }
+
+    /**
+     * @brief Handle destructor
+     */
+    ~node_handle_t() {
+      Reset();
+    }
+  };
+
+  /**
+   * @brief Split deque into two parts
+   *
+   * The nodes are relinked without copying. Counting the moved elements takes
+   * O(min(k, n - k)) steps, where k is position of the split.
+   *
+   * @param[in] pos iterator to the first element to move to the new deque
+   * @return deque with elements from 'pos' to the end, this deque keeps elements before 'pos'
+   */
+  deque_t SplitAt(iterator pos) {
+    deque_t result(alloc);
+    link_t* first = pos.data;
+    if (first == &sentinel)
+      return result;
+
+    size_t count = 0;
+    link_t* forward = first;
+    link_t* backward = first->prev;
+    while (forward != &sentinel && backward != &sentinel) {
+      forward = forward->next;
+      backward = backward->prev;
+      ++count;
+    }
+    if (forward != &sentinel) {
+      // 'count' elements precede 'pos'
+      count = size - count;
+    }
+
+    link_t* last = sentinel.prev;
+    link_t* kept = first->prev;
+    kept->next = &sentinel;
+    sentinel.prev = kept;
+    size -= count;
+    stats.OnErase(count);
+
+    LinkBefore(&result.sentinel, first, last);
+    result.size = count;
+    result.stats.OnInsert(count, count);
+    return result;
+  }
+
+  /**
+   * @brief Construct element in place before given position
+   * @param[in] pos iterator before which the element is inserted
+   * @param[in] args arguments for the element constructor
+   * @return iterator pointing to the new element
+   */
+  template <typename... Args>
+  iterator Emplace(const_iterator pos, Args&&... args) {
+    node_t* newNode = CreateNode(std::forward<Args>(args)...);
+    LinkBefore(pos.data, newNode, newNode);
+    ++size;
+    stats.OnInsert(1, size);
+    return iterator(newNode);
+  }
+
+  /**
+   * @brief Insert element before given position
+   * @param[in] pos iterator before which the element is inserted
+   * @param[in] value element to add
+   * @return iterator pointing to the new element
+   */
+  iterator Insert(const_iterator pos, T const& value) {
+    return Emplace(pos, value);
+  }
+
+  /**
+   * @brief Insert element before given position
+   * @param[in] pos iterator before which the element is inserted
+   * @param[in] value element to move
+   * @return iterator pointing to the new element
+   */
+  iterator Insert(const_iterator pos, T&& value) {
+    return Emplace(pos, std::move(value));
+  }
+
+  /**
+   * @brief Insert extracted node before given position
+   *
+   * The node is relinked without allocation if allocators are equal, otherwise
+   * the value is moved to a new node and the handle's node is freed.
+   *
+   * @param[in] pos iterator before which the element is inserted
+   * @param[in] handle handle with the node (becomes empty)
+   * @return iterator pointing to the inserted element (end() if the handle is empty)
+   */
+  iterator Insert(const_iterator pos, node_handle_t&& handle) {
+    if (handle.IsEmpty())
+      return end();
+
+    if (!(*handle.nodeAlloc == nodeAlloc)) {
+      iterator result = Emplace(pos, std::move(handle.Value()));
+      handle.Reset();
+      return result;
+    }
+
+    node_t* node = handle.Release();
+    LinkBefore(pos.data, node, node);
+    ++size;
+    stats.OnInsert(1, size);
+    return iterator(node);
+  }
+
+  /**
+   * @brief Remove element at given position
+   * @param[in] pos iterator pointing to the element (must not be end())
+   * @return iterator pointing to the element after the removed one
+   */
+  iterator Erase(const_iterator pos) {
+    link_t* link = pos.data;
+    link_t* next = link->next;
+    link->prev->next = next;
+    next->prev = link->prev;
+    --size;
+    stats.OnErase(1);
+    DestroyNode(AsNode(link));
+    return iterator(next);
+  }
+
+  /**
+   * @brief Remove range of elements
+   * @param[in] first iterator pointing to the first element to remove
+   * @param[in] last iterator pointing after the last element to remove
+   * @return iterator pointing to the element after the removed ones
+   */
+  iterator Erase(const_iterator first, const_iterator last) {
+    link_t* link = first.data;
+    link_t* stop = last.data;
+    if (link == stop)
+      return iterator(stop);
+
+    size_t count = 0;
+    for (link_t* counted = link; counted != stop; counted = counted->next)
+      ++count;
+
+    link_t* prev = link->prev;
+    prev->next = stop;
+    stop->prev = prev;
+    size -= count;
+    stats.OnErase(count);
+    FreeChain(link, stop);
+    return iterator(stop);
+  }
+
+  /**
+   * @brief Unlink element and give its node to handle
+   *
+   * Neither the value nor the node is copied or freed.
+   *
+   * @param[in] pos iterator pointing to the element (must not be end())
+   * @return handle owning the node
+   */
+  node_handle_t Extract(const_iterator pos) {
+    link_t* link = pos.data;
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    --size;
+    stats.OnErase(1);
+    return node_handle_t(AsNode(link), nodeAlloc);
+  }
+
   /*
    * @brief Begin of deque
    * @return iterator pointed to the first element of deque
    */
-  iterator begin() const {
-    return iterator(head, head, tail);
+  iterator begin() {
+    return iterator(sentinel.next);
   }
 
   /*
    * @brief End of deque
    * @return iterator pointed to the next after last element of deque
    */
-  iterator end() const {
-    return iterator(tail->next, head, tail);
+  iterator end() {
+    return iterator(&sentinel);
+  }
+
+  /*
+   * @brief Begin of deque
+   * @return const iterator pointed to the first element of deque
+   */
+  const_iterator begin() const {
+    return cbegin();
+  }
+
+  /*
+   * @brief End of deque
+   * @return const iterator pointed to the next after last element of deque
+   */
+  const_iterator end() const {
+    return cend();
   }
 
   std::reverse_iterator<iterator> rbegin() {
-    return (std::reverse_iterator<iterator>)end();
+    return std::reverse_iterator<iterator>(end());
   }
 
   std::reverse_iterator<iterator> rend() {
-    return (std::reverse_iterator<iterator>)begin();
+    return std::reverse_iterator<iterator>(begin());
+  }
+
+  std::reverse_iterator<const_iterator> rbegin() const {
+    return std::reverse_iterator<const_iterator>(end());
+  }
+
+  std::reverse_iterator<const_iterator> rend() const {
+    return std::reverse_iterator<const_iterator>(begin());
   }
 
   /*
@@ -370,7 +1152,7 @@ public:
    * @return const iterator pointed to the first element of deque
    */
   const_iterator cbegin() const noexcept {
-    return const_iterator(head, head, tail);
+    return const_iterator(sentinel.next);
   }
 
   /*
@@ -379,15 +1161,69 @@ public:
    * @warning dereferencing can cause undefined behaviour
    */
   const_iterator cend() const noexcept {
-    return const_iterator(tail->next, head, tail);
+    return const_iterator(End());
   }
 
   /**
    * @brief Clear deque
+   *
+   * The list is walked once without keeping the deque consistent per element.
+   * Nodes are returned to the node pool or the allocator.
    */
   void Clear() {
-    while (head != nullptr)
-      PopBack();
+    FreeChain(sentinel.next, &sentinel);
+    ResetLinks();
+  }
+
+  /**
+   * @brief Clear deque leaving node memory to the allocator reset
+   *
+   * Elements are destroyed (not at all for trivially destructible 'T'), but neither they
+   * nor the cached nodes are deallocated. Call it right before resetting the arena
+   * (see arena_t::Reset); the deque stays usable.
+   *
+   * @warning memory of the nodes is lost until the allocator is reset
+   */
+  void ClearForArenaReset() {
+    static_assert(is_resettable_allocator<Allocator>::value, "ClearForArenaReset requires resettable allocator");
+    if constexpr (!std::is_trivially_destructible<T>::value)
+      for (link_t* link = sentinel.next; link != &sentinel; link = link->next)
+        node_allocator_traits::destroy(nodeAlloc, &AsNode(link)->data);
+    ResetLinks();
+    freeNodes = nullptr;
+    freeCount = 0;
+  }
+
+  /**
+   * @brief Set how many retired nodes the deque keeps for reuse
+   *
+   * With a non-zero limit PopBack/PopFront put nodes to the free list and
+   * PushBack/PushFront take them from it, so steady-state push/pop does not call the allocator.
+   *
+   * @param[in] limit maximum number of cached nodes (0 disables the pool)
+   */
+  void SetNodePoolLimit(size_t limit) {
+    poolLimit = limit;
+    while (freeCount > poolLimit) {
+      node_t* node = freeNodes;
+      freeNodes = AsNode(node->next);
+      --freeCount;
+      stats.OnDeallocate();
+      node_allocator_traits::deallocate(nodeAlloc, node, 1);
+    }
+  }
+
+  /**
+   * @brief Release all cached nodes to the allocator
+   */
+  void ShrinkToFit() {
+    while (freeNodes != nullptr) {
+      node_t* node = freeNodes;
+      freeNodes = AsNode(node->next);
+      stats.OnDeallocate();
+      node_allocator_traits::deallocate(nodeAlloc, node, 1);
+    }
+    freeCount = 0;
   }
 
   /**
@@ -395,5 +1231,6 @@ public:
    */
   ~deque_t() {
     Clear();
+    ShrinkToFit();
   }
 };
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Parallel algorithms over deques with contiguous segments
+ *
+ * The deque (block_deque_t, ring_deque_t) is split into equal index ranges, one per
+ * thread, and every thread walks its range through ForEachSegment(pos, count, fn), so
+ * the inner loops run over contiguous memory. The calling thread processes the first range.
+ * Both deques also have random-access iterators, so standard parallel algorithms
+ * can partition them too.
+ */
+namespace deque_parallel {
+  inline constexpr size_t minChunk = 4096;    ///< minimum number of elements per thread
+
+  /**
+   * @brief Get number of ranges to split elements into
+   * @param[in] size number of elements
+   * @param[in] threads maximum number of threads (0 for hardware concurrency)
+   * @return number of non-empty ranges, at least one
+   */
+  inline size_t ChunkCount(size_t size, size_t threads) {
+    if (threads == 0)
+      threads = std::thread::hardware_concurrency();
+    size_t byWork = (size + minChunk - 1) / minChunk;
+    size_t chunks = threads < byWork ? threads : byWork;
+    return chunks == 0 ? 1 : chunks;
+  }
+
+  /**
+   * @brief Run function for every range of elements on its own thread
+   *
+   * The first exception thrown by a range is rethrown after all threads are joined.
+   *
+   * @param[in] size number of elements
+   * @param[in] chunks number of ranges (see ChunkCount)
+   * @param[in] fn function called with index of the range, index of its first element and its size
+   */
+  template <typename Fn>
+  void RunChunks(size_t size, size_t chunks, Fn&& fn) {
+    std::vector<std::exception_ptr> errors(chunks);
+    auto runChunk = [&](size_t chunk) {
+      size_t first = size / chunks * chunk + (chunk < size % chunks ? chunk : size % chunks);
+      size_t count = size / chunks + (chunk < size % chunks ? 1 : 0);
+      try {
+        fn(chunk, first, count);
+      }
+      catch (...) {
+        errors[chunk] = std::current_exception();
+      }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    try {
+      for (size_t chunk = 1; chunk < chunks; ++chunk)
+        workers.emplace_back(runChunk, chunk);
+    }
+    catch (...) {
+      for (auto& worker : workers)
+        worker.join();
+      throw;
+    }
+    runChunk(0);
+    for (auto& worker : workers)
+      worker.join();
+
+    for (auto& error : errors)
+      if (error)
+        std::rethrow_exception(error);
+  }
+
+  /**
+   * @brief Call function for every element of deque in parallel
+   * @param[in] deque deque with ForEachSegment(pos, count, fn)
+   * @param[in] fn function called with reference to each element (called concurrently)
+   * @param[in] threads maximum number of threads (0 for hardware concurrency)
+   */
+  template <typename Deque, typename Fn>
+  void ForEach(Deque& deque, Fn fn, size_t threads = 0) {
+    size_t size = deque.Size();
+    RunChunks(size, ChunkCount(size, threads), [&](size_t, size_t first, size_t count) {
+      deque.ForEachSegment(first, count, [&](auto segment) {
+        for (auto& value : segment)
+          fn(value);
+      });
+    });
+  }
+
+  /**
+   * @brief Reduce elements of deque in parallel
+   *
+   * Every thread folds its range from left to right, then the partial results are
+   * folded into 'init' in order of the ranges.
+   *
+   * @param[in] deque deque with ForEachSegment(pos, count, fn)
+   * @param[in] init initial value (elements must be convertible to its type)
+   * @param[in] op associative binary operation (called concurrently)
+   * @param[in] threads maximum number of threads (0 for hardware concurrency)
+   * @return result of the reduction ('init' for empty deque)
+   */
+  template <typename Deque, typename R, typename Op>
+  R Reduce(Deque const& deque, R init, Op op, size_t threads = 0) {
+    size_t size = deque.Size();
+    if (size == 0)
+      return init;
+
+    size_t chunks = ChunkCount(size, threads);
+    std::vector<std::optional<R>> partial(chunks);
+    RunChunks(size, chunks, [&](size_t chunk, size_t first, size_t count) {
+      std::optional<R>& acc = partial[chunk];
+      deque.ForEachSegment(first, count, [&](auto segment) {
+        for (auto const& value : segment) {
+          if (acc)
+            *acc = op(std::move(*acc), value);
+          else
+            acc.emplace(value);
+        }
+      });
+    });
+
+    for (auto& value : partial)
+      init = op(std::move(init), std::move(*value));
+    return init;
+  }
+}
@@ -0,0 +1,344 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "block_deque.h"
+#include "concurrent_deque.h"
+#include "deque.h"
+#include "deque_stats.h"
+#include "ring_deque.h"
+#include "static_deque.h"
+
+/**
+ * @brief Storage policies of deque_policy
+ */
+namespace deque_storage {
+  /**
+   * @brief Doubly linked list of nodes (deque_t)
+   */
+  struct list {};
+
+  /**
+   * @brief Fixed-size blocks with a central map (block_deque_t)
+   * @tparam BlockSize number of elements in one block (power of two, 0 for DefaultBlockSize<T>())
+   */
+  template <size_t BlockSize = 0>
+  struct blocks {};
+
+  /**
+   * @brief Fixed-size blocks sized in bytes (block_deque_t)
+   *
+   * The block holds the largest power of two elements fitting in 'Bytes', at least one,
+   * so one policy gives page- or cache-line-sized blocks for any 'T'.
+   *
+   * @tparam Bytes target size of one block in bytes
+   */
+  template <size_t Bytes>
+  struct blocks_of_bytes {};
+
+  /**
+   * @brief Contiguous ring buffer (ring_deque_t)
+   * @tparam InlineCapacity number of elements stored inside the deque before the heap is used
+   */
+  template <size_t InlineCapacity = 0>
+  struct ring {};
+}
+
+/**
+ * @brief Growth policies of deque_policy
+ */
+namespace deque_growth {
+  /**
+   * @brief Storage grows as needed (ring buffer and block map are doubled)
+   */
+  struct doubling {};
+
+  /**
+   * @brief Capacity fixed at compile time, nothing is allocated (static_deque_t, ring storage only)
+   *
+   * Takes neither an allocator nor an inline capacity: the default Allocator and
+   * deque_storage::ring<0> are required, other values fail to compile.
+   *
+   * @tparam Capacity maximum number of elements
+   */
+  template <size_t Capacity>
+  struct fixed {};
+}
+
+/**
+ * @brief Thread-safety policies of deque_policy
+ */
+namespace deque_sync {
+  /**
+   * @brief Not thread-safe, the container itself
+   */
+  struct none {};
+
+  /**
+   * @brief Every operation under a mutex (locked_deque_t)
+   */
+  struct mutex {};
+
+  /**
+   * @brief Lock-free deque (concurrent_deque_t, list storage only)
+   */
+  struct lock_free {};
+}
+
+/**
+ * @brief Policy bundle for deque_t
+ *
+ * deque_t<T, Allocator, deque_policy<...>> is the container picked by the policies, selected
+ * at compile time, so every combination runs the code of the hand-written class:
+ * list - deque_t, blocks - block_deque_t, ring - ring_deque_t, ring with fixed growth - static_deque_t;
+ * deque_sync::mutex wraps the container into locked_deque_t. Statistics are collected by
+ * list storage only. Unsupported combinations fail to compile.
+ *
+ * @tparam Storage deque_storage policy
+ * @tparam Growth deque_growth policy
+ * @tparam Sync deque_sync policy
+ * @tparam Stats statistics policy (deque_stats_off, deque_stats_on or deque_stats_sampled)
+ */
+template <typename Storage = deque_storage::list, typename Growth = deque_growth::doubling,
+  typename Sync = deque_sync::none, typename Stats = deque_stats_off>
+struct deque_policy {
+  using storage = Storage;            ///< storage policy
+  using growth = Growth;              ///< growth policy
+  using sync = Sync;                  ///< thread-safety policy
+  using stats = Stats;                ///< statistics policy
+};
+
+/**
+ * @brief Mutex-protected deque class
+ *
+ * Thread-safe wrapper with the interface of concurrent_deque_t (TryPush*, TryPop*)
+ * over any deque of this repository; WithLock() runs other operations under the lock.
+ *
+ * @tparam Deque wrapped deque type
+ */
+template <typename Deque>
+class locked_deque_t {
+private:
+  using T = std::remove_cvref_t<decltype(std::declval<Deque&>().Front())>;
+
+  Deque deque;                        ///< stored elements
+  mutable std::mutex mutex;           ///< protects the deque
+
+  /**
+   * @brief Push element at given end under the lock
+   * @param[in] value element to add
+   * @param[in] atBack true to push to the end, false to push to the begin
+   * @return false if the deque has fixed capacity and is full, true otherwise
+   */
+  template <typename U>
+  bool TryPush(U&& value, bool atBack) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if constexpr (requires { deque.TryPushBack(std::forward<U>(value)); })
+      return atBack ? deque.TryPushBack(std::forward<U>(value)) : deque.TryPushFront(std::forward<U>(value));
+    else {
+      if (atBack)
+        deque.PushBack(std::forward<U>(value));
+      else
+        deque.PushFront(std::forward<U>(value));
+      return true;
+    }
+  }
+
+public:
+  /**
+   * @brief Constructor forwarding arguments to the wrapped deque
+   * @param[in] args arguments for the deque constructor
+   */
+  template <typename... Args>
+  explicit locked_deque_t(Args&&... args) : deque(std::forward<Args>(args)...) {};
+
+  locked_deque_t(locked_deque_t const&) = delete;
+  locked_deque_t& operator=(locked_deque_t const&) = delete;
+
+  /**
+   * @brief Get deque size method
+   * @return number of elements in the deque
+   */
+  size_t Size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return deque.Size();
+  }
+
+  /**
+   * @brief Check is deque empty method
+   * @return true if deque is empty, false otherwise
+   */
+  bool IsEmpty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return deque.IsEmpty();
+  }
+
+  /**
+   * @brief Put element to end of deque
+   * @param[in] value element to add
+   * @return false if the deque has fixed capacity and is full, true otherwise
+   */
+  bool TryPushBack(T const& value) {
+    return TryPush(value, true);
+  }
+
+  /**
+   * @brief Put element to end of deque
+   * @param[in] value element to move
+   * @return false if the deque has fixed capacity and is full, true otherwise
+   */
+  bool TryPushBack(T&& value) {
+    return TryPush(std::move(value), true);
+  }
+
+  /**
+   * @brief Put element to begin of deque
+   * @param[in] value element to add
+   * @return false if the deque has fixed capacity and is full, true otherwise
+   */
+  bool TryPushFront(T const& value) {
+    return TryPush(value, false);
+  }
+
+  /**
+   * @brief Put element to begin of deque
+   * @param[in] value element to move
+   * @return false if the deque has fixed capacity and is full, true otherwise
+   */
+  bool TryPushFront(T&& value) {
+    return TryPush(std::move(value), false);
+  }
+
+  /**
+   * @brief Take element from the front of deque
+   * @param[out] value the taken element
+   * @return true if an element was taken, false if deque is empty
+   */
+  bool TryPopFront(T& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (deque.IsEmpty())
+      return false;
+    value = std::move(deque.Front());
+    deque.PopFront();
+    return true;
+  }
+
+  /**
+   * @brief Take element from the back of deque
+   * @param[out] value the taken element
+   * @return true if an element was taken, false if deque is empty
+   */
+  bool TryPopBack(T& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (deque.IsEmpty())
+      return false;
+    value = std::move(deque.Back());
+    deque.PopBack();
+    return true;
+  }
+
+  /**
+   * @brief Call function with the wrapped deque under the lock
+   * @param[in] fn function called with reference to the deque
+   * @return result of the function
+   */
+  template <typename Fn>
+  decltype(auto) WithLock(Fn&& fn) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::forward<Fn>(fn)(deque);
+  }
+
+  /**
+   * @brief Clear deque
+   */
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    deque.Clear();
+  }
+};
+
+/**
+ * @brief Select not thread-safe container for storage and growth policies
+ *
+ * Combinations without specialization are not supported.
+ */
+template <typename T, typename Allocator, typename Storage, typename Growth, typename Stats>
+struct deque_storage_select {
+  static_assert(!std::is_same_v<T, T>, "unsupported combination of deque policies (statistics need list storage, fixed growth needs ring storage)");
+};
+
+template <typename T, typename Allocator, typename Stats>
+struct deque_storage_select<T, Allocator, deque_storage::list, deque_growth::doubling, Stats> {
+  using type = deque_t<T, Allocator, Stats>;
+};
+
+template <typename T, typename Allocator, size_t BlockSize>
+struct deque_storage_select<T, Allocator, deque_storage::blocks<BlockSize>, deque_growth::doubling, deque_stats_off> {
+  using type = block_deque_t<T, Allocator, BlockSize == 0 ? DefaultBlockSize<T>() : BlockSize>;
+};
+
+template <typename T, typename Allocator, size_t Bytes>
+struct deque_storage_select<T, Allocator, deque_storage::blocks_of_bytes<Bytes>, deque_growth::doubling, deque_stats_off> {
+  static constexpr size_t blockSize = Bytes / sizeof(T) < 2 ? 1 : std::bit_floor(Bytes / sizeof(T));
+  using type = block_deque_t<T, Allocator, blockSize>;
+};
+
+template <typename T, typename Allocator, size_t InlineCapacity>
+struct deque_storage_select<T, Allocator, deque_storage::ring<InlineCapacity>, deque_growth::doubling, deque_stats_off> {
+  using type = ring_deque_t<T, Allocator, InlineCapacity>;
+};
+
+template <typename T, typename Allocator, size_t InlineCapacity, size_t Capacity>
+struct deque_storage_select<T, Allocator, deque_storage::ring<InlineCapacity>, deque_growth::fixed<Capacity>, deque_stats_off> {
+  static_assert(InlineCapacity == 0, "fixed growth stores all elements inline, leave ring InlineCapacity at 0");
+  static_assert(std::is_same_v<Allocator, std::allocator<T>>, "fixed growth never allocates, leave Allocator at its default");
+  using type = static_deque_t<T, Capacity>;
+};
+
+/**
+ * @brief Select container for policy bundle
+ */
+template <typename T, typename Allocator, typename Policy, typename Sync = typename Policy::sync>
+struct deque_policy_select {
+  static_assert(!std::is_same_v<T, T>, "unknown deque_sync policy");
+};
+
+template <typename T, typename Allocator, typename Policy>
+struct deque_policy_select<T, Allocator, Policy, deque_sync::none> {
+  using type = typename deque_storage_select<T, Allocator, typename Policy::storage, typename Policy::growth, typename Policy::stats>::type;
+};
+
+template <typename T, typename Allocator, typename Policy>
+struct deque_policy_select<T, Allocator, Policy, deque_sync::mutex> {
+  using type = locked_deque_t<typename deque_storage_select<T, Allocator, typename Policy::storage, typename Policy::growth, typename Policy::stats>::type>;
+};
+
+template <typename T, typename Allocator, typename Policy>
+struct deque_policy_select<T, Allocator, Policy, deque_sync::lock_free> {
+  static_assert(std::is_same_v<typename Policy::storage, deque_storage::list> && std::is_same_v<typename Policy::growth, deque_growth::doubling>
+    && std::is_same_v<typename Policy::stats, deque_stats_off>, "lock-free deque supports list storage without statistics only");
+  using type = concurrent_deque_t<T, Allocator>;
+};
+
+/**
+ * @brief Deque configured by policy bundle
+ *
+ * Is the container selected by the policies, with its interface and constructors.
+ *
+ * @tparam T type of stored elements
+ * @tparam Allocator the allocator to be used (must be the default with fixed growth)
+ */
+template <typename T, typename Allocator, typename Storage, typename Growth, typename Sync, typename Stats>
+class deque_t<T, Allocator, deque_policy<Storage, Growth, Sync, Stats>>
+  : public deque_policy_select<T, Allocator, deque_policy<Storage, Growth, Sync, Stats>>::type {
+public:
+  using policy = deque_policy<Storage, Growth, Sync, Stats>;                       ///< the policy bundle
+  using container_type = typename deque_policy_select<T, Allocator, policy>::type;  ///< the selected container
+
+  using container_type::container_type;
+};
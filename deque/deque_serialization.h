@@ -0,0 +1,362 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/uio.h>
+#include <unistd.h>
+#define DEQUE_SERIALIZATION_POSIX 1
+#endif
+
+/**
+ * @brief Binary serialization of deques of trivially copyable elements
+ *
+ * The format is a fixed header (signature, version, element size, element count)
+ * followed by the raw bytes of the elements in order, in the byte order of the machine.
+ * Deques with ForEachSegment() (block_deque_t, ring_deque_t) hand their contiguous
+ * parts to the writer as a scatter-gather list without copying; deque_t elements are
+ * gathered into a staging buffer first. Loading is incremental: deque_loader_t takes
+ * bytes in chunks of any size and pushes every completed element to the deque.
+ *
+ * A writer is a function called with std::span<std::span<std::byte const> const>, the parts
+ * to write in order. A reader is a function called with std::span<std::byte>, which
+ * fills a prefix of the buffer and returns its size (0 at the end of the data).
+ */
+namespace deque_serialization {
+  inline constexpr uint64_t magic = 0x4c52455345555144ull;  ///< "DQUESERL" signature
+  inline constexpr uint32_t version = 1;                    ///< format version
+  inline constexpr size_t maxParts = 64;                    ///< maximum number of parts per writer call
+  inline constexpr size_t bufferBytes = 1 << 16;            ///< size of staging and reading buffers
+  inline constexpr uint64_t maxReserved = 1 << 20;          ///< maximum number of elements reserved from the header count
+
+  /**
+   * @brief Serialized header
+   */
+  struct header_t {
+    uint64_t magic;           ///< signature
+    uint32_t version;         ///< format version
+    uint32_t elementSize;     ///< sizeof(T) of the serialized deque
+    uint64_t count;           ///< number of elements
+  };
+
+  /**
+   * @brief Write deque
+   * @param[in] deque deque of trivially copyable elements
+   * @param[in] writer function writing scatter-gather list of parts
+   */
+  template <typename Deque, typename Writer>
+  void SerializeTo(Deque const& deque, Writer&& writer) {
+    using T = std::remove_cvref_t<decltype(deque.Front())>;
+    static_assert(std::is_trivially_copyable<T>::value, "SerializeTo requires trivially copyable T");
+
+    header_t header = { magic, version, (uint32_t)sizeof(T), (uint64_t)deque.Size() };
+    std::span<std::byte const> parts[maxParts];
+    size_t count = 0;
+    parts[count++] = std::as_bytes(std::span<header_t const>(&header, 1));
+
+    auto flush = [&]() {
+      writer(std::span<std::span<std::byte const> const>(parts, count));
+      count = 0;
+    };
+
+    if constexpr (requires { deque.ForEachSegment([](std::span<T const>) {}); }) {
+      deque.ForEachSegment([&](std::span<T const> segment) {
+        if (count == maxParts)
+          flush();
+        parts[count++] = std::as_bytes(segment);
+      });
+      flush();
+    }
+    else {
+      // no contiguous storage, gather elements into the staging buffer
+      constexpr size_t perBuffer = bufferBytes / sizeof(T) > 0 ? bufferBytes / sizeof(T) : 1;
+      std::unique_ptr<std::byte[]> staging(new std::byte[perBuffer * sizeof(T)]);
+      size_t staged = 0;
+      for (T const& value : deque) {
+        std::memcpy(staging.get() + staged * sizeof(T), &value, sizeof(T));
+        if (++staged == perBuffer) {
+          parts[count++] = std::span<std::byte const>(staging.get(), staged * sizeof(T));
+          flush();
+          staged = 0;
+        }
+      }
+      if (staged > 0)
+        parts[count++] = std::span<std::byte const>(staging.get(), staged * sizeof(T));
+      flush();
+    }
+  }
+
+  /**
+   * @brief Incremental loader of serialized deque
+   *
+   * Bytes are fed as they arrive; elements are pushed to the back of the deque as soon
+   * as all their bytes are fed, so only a partial element is buffered.
+   *
+   * @tparam Deque deque type with PushBack()
+   */
+  template <typename Deque>
+  class deque_loader_t {
+  private:
+    using T = std::remove_cvref_t<decltype(std::declval<Deque&>().Front())>;
+    static_assert(std::is_trivially_copyable<T>::value, "deque_loader_t requires trivially copyable T");
+
+    Deque& deque;                               ///< deque to fill
+    header_t header;                            ///< header being read
+    size_t headerFed;                           ///< number of fed bytes of the header
+    uint64_t loaded;                            ///< number of loaded elements
+    alignas(T) std::byte partial[sizeof(T)];    ///< bytes of the incomplete element
+    size_t partialFed;                          ///< number of bytes in 'partial'
+
+    /**
+     * @brief Check header after it is read
+     */
+    void CheckHeader() {
+      if (header.magic != magic || header.version != version)
+        throw std::runtime_error("serialized deque has unknown format");
+      if (header.elementSize != sizeof(T))
+        throw std::runtime_error("serialized deque has different element size");
+      // the count is not trusted yet, larger deques grow as elements arrive
+      if constexpr (requires { deque.Reserve(size_t()); })
+        deque.Reserve(deque.Size() + (size_t)(header.count < maxReserved ? header.count : maxReserved));
+    }
+
+    /**
+     * @brief Push element from bytes
+     * @param[in] bytes sizeof(T) bytes of the element
+     */
+    void Push(std::byte const* bytes) {
+      // T need not be default constructible
+      std::array<std::byte, sizeof(T)> raw;
+      std::memcpy(raw.data(), bytes, sizeof(T));
+      deque.PushBack(std::bit_cast<T>(raw));
+      ++loaded;
+    }
+
+  public:
+    /**
+     * @brief Constructor of loader
+     * @param[in] deque deque to append the elements to
+     */
+    explicit deque_loader_t(Deque& deque) : deque(deque), header(), headerFed(0), loaded(0), partialFed(0) {};
+
+    deque_loader_t(deque_loader_t const&) = delete;
+    deque_loader_t& operator=(deque_loader_t const&) = delete;
+
+    /**
+     * @brief Feed next bytes
+     * @param[in] bytes next part of the serialized data
+     * @throw std::runtime_error if the header is invalid or there are bytes after the last element
+     */
+    void Feed(std::span<std::byte const> bytes) {
+      std::byte const* data = bytes.data();
+      size_t n = bytes.size();
+
+      if (headerFed < sizeof(header_t)) {
+        size_t part = sizeof(header_t) - headerFed < n ? sizeof(header_t) - headerFed : n;
+        std::memcpy(reinterpret_cast<std::byte*>(&header) + headerFed, data, part);
+        headerFed += part;
+        data += part;
+        n -= part;
+        if (headerFed < sizeof(header_t))
+          return;
+        CheckHeader();
+      }
+
+      uint64_t remaining = header.count - loaded;
+      if (partialFed > 0) {
+        size_t part = sizeof(T) - partialFed < n ? sizeof(T) - partialFed : n;
+        std::memcpy(partial + partialFed, data, part);
+        partialFed += part;
+        data += part;
+        n -= part;
+        if (partialFed < sizeof(T))
+          return;
+        Push(partial);
+        partialFed = 0;
+        --remaining;
+      }
+
+      if ((uint64_t)(n / sizeof(T)) > remaining || ((uint64_t)(n / sizeof(T)) == remaining && n % sizeof(T) != 0))
+        throw std::runtime_error("serialized deque has extra bytes");
+      for (; n >= sizeof(T); data += sizeof(T), n -= sizeof(T))
+        Push(data);
+      std::memcpy(partial, data, n);
+      partialFed = n;
+    }
+
+    /**
+     * @brief Check are all elements loaded
+     * @return true if the header and all elements are fed, false otherwise
+     */
+    bool IsComplete() const {
+      return headerFed == sizeof(header_t) && loaded == header.count;
+    }
+
+    /**
+     * @brief Get number of bytes the loader still expects
+     *
+     * Until the header is complete only the rest of the header is counted,
+     * so a reader asking for at most this many bytes never reads past the deque.
+     *
+     * @return number of bytes up to the end of the header or of the last element (saturated to SIZE_MAX)
+     */
+    size_t Remaining() const {
+      if (headerFed < sizeof(header_t))
+        return sizeof(header_t) - headerFed;
+      uint64_t elements = header.count - loaded;
+      if (elements > (SIZE_MAX - sizeof(T)) / sizeof(T))
+        return SIZE_MAX;
+      return (size_t)elements * sizeof(T) - partialFed;
+    }
+
+    /**
+     * @brief Get number of loaded elements
+     * @return number of elements pushed to the deque
+     */
+    size_t Loaded() const {
+      return (size_t)loaded;
+    }
+  };
+
+  /**
+   * @brief Read deque
+   *
+   * The elements are appended to the back of the deque while they are read.
+   * The reader is never asked for bytes after the deque, so data following it
+   * (e.g. another serialized deque) stays unread.
+   *
+   * @param[in] deque deque to append the elements to
+   * @param[in] reader function reading next bytes
+   * @throw std::runtime_error if the data is invalid or truncated
+   */
+  template <typename Deque, typename Reader>
+  void DeserializeFrom(Deque& deque, Reader&& reader) {
+    deque_loader_t<Deque> loader(deque);
+    std::unique_ptr<std::byte[]> buffer(new std::byte[bufferBytes]);
+    while (!loader.IsComplete()) {
+      size_t request = loader.Remaining() < bufferBytes ? loader.Remaining() : bufferBytes;
+      size_t n = reader(std::span<std::byte>(buffer.get(), request));
+      if (n == 0)
+        throw std::runtime_error("serialized deque is truncated");
+      loader.Feed(std::span<std::byte const>(buffer.get(), n));
+    }
+  }
+
+  /**
+   * @brief Writer to std::ostream
+   */
+  struct ostream_writer_t {
+    std::ostream& stream;     ///< stream to write to
+
+    /**
+     * @brief Write parts
+     * @param[in] parts parts to write in order
+     * @throw std::runtime_error if the stream fails
+     */
+    void operator()(std::span<std::span<std::byte const> const> parts) const {
+      for (std::span<std::byte const> part : parts)
+        stream.write(reinterpret_cast<char const*>(part.data()), (std::streamsize)part.size());
+      if (!stream)
+        throw std::runtime_error("failed to write serialized deque");
+    }
+  };
+
+  /**
+   * @brief Reader from std::istream
+   */
+  struct istream_reader_t {
+    std::istream& stream;     ///< stream to read from
+
+    /**
+     * @brief Read next bytes
+     * @param[in] buffer buffer to read to
+     * @return number of read bytes (0 at the end of the stream)
+     */
+    size_t operator()(std::span<std::byte> buffer) const {
+      stream.read(reinterpret_cast<char*>(buffer.data()), (std::streamsize)buffer.size());
+      return (size_t)stream.gcount();
+    }
+  };
+
+#if defined(DEQUE_SERIALIZATION_POSIX)
+  /**
+   * @brief Writer to file descriptor with writev
+   */
+  struct fd_writer_t {
+    int fd;                   ///< file descriptor to write to
+
+    /**
+     * @brief Write parts with one writev call (more calls on partial writes)
+     * @param[in] parts parts to write in order
+     * @throw std::system_error if writev fails
+     */
+    void operator()(std::span<std::span<std::byte const> const> parts) const {
+      iovec vectors[maxParts];
+      size_t count = parts.size() < maxParts ? parts.size() : maxParts;
+      for (size_t i = 0; i < count; ++i)
+        vectors[i] = iovec{ const_cast<std::byte*>(parts[i].data()), parts[i].size() };
+
+      iovec* first = vectors;
+      while (count > 0) {
+        ssize_t written = ::writev(fd, first, (int)count);
+        if (written < 0) {
+          if (errno == EINTR)
+            continue;
+          throw std::system_error(errno, std::generic_category(), "writev");
+        }
+
+        // skip written parts and the written prefix of the first unfinished one
+        size_t rest = (size_t)written;
+        while (count > 0 && rest >= first->iov_len) {
+          rest -= first->iov_len;
+          ++first;
+          --count;
+        }
+        if (count > 0) {
+          first->iov_base = static_cast<char*>(first->iov_base) + rest;
+          first->iov_len -= rest;
+        }
+      }
+
+      if (parts.size() > maxParts)
+        (*this)(parts.subspan(maxParts));
+    }
+  };
+
+  /**
+   * @brief Reader from file descriptor
+   */
+  struct fd_reader_t {
+    int fd;                   ///< file descriptor to read from
+
+    /**
+     * @brief Read next bytes
+     * @param[in] buffer buffer to read to
+     * @return number of read bytes (0 at the end of the file)
+     * @throw std::system_error if read fails
+     */
+    size_t operator()(std::span<std::byte> buffer) const {
+      for (;;) {
+        ssize_t n = ::read(fd, buffer.data(), buffer.size());
+        if (n >= 0)
+          return (size_t)n;
+        if (errno != EINTR)
+          throw std::system_error(errno, std::generic_category(), "read");
+      }
+    }
+  };
+#endif
+}
@@ -0,0 +1,401 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DEQUE_SIMD_AVX2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define DEQUE_SIMD_NEON 1
+#endif
+
+/**
+ * @brief Vectorized algorithms over deques with contiguous segments
+ *
+ * The algorithms walk a deque through ForEachSegment() (block_deque_t, ring_deque_t)
+ * and run a kernel on each contiguous part. Kernels use AVX2 (when compiled with it) or
+ * NEON (AArch64) for float, double and int32_t; other arithmetic types and builds without
+ * these instruction sets use scalar loops.
+ */
+namespace deque_simd {
+  /**
+   * @brief Type of elements of deque
+   * @tparam Deque deque type
+   */
+  template <typename Deque>
+  using element_t = std::remove_cvref_t<decltype(std::declval<Deque const&>().Front())>;
+
+  /**
+   * @brief Sum elements of contiguous segment
+   *
+   * Lanes are summed separately, so for floating point 'T' the rounding may differ
+   * from the sequential sum.
+   *
+   * @param[in] segment elements to sum
+   * @return sum of the elements
+   */
+  template <typename T>
+  T SumSegment(std::span<T const> segment) {
+    static_assert(std::is_arithmetic_v<T>, "SumSegment requires arithmetic T");
+    T const* data = segment.data();
+    size_t n = segment.size();
+    size_t i = 0;
+    T result = T();
+
+#if defined(DEQUE_SIMD_AVX2)
+    if constexpr (std::is_same_v<T, float>) {
+      __m256 acc0 = _mm256_setzero_ps();
+      __m256 acc1 = _mm256_setzero_ps();
+      for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(data + i));
+        acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(data + i + 8));
+      }
+      for (; i + 8 <= n; i += 8)
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(data + i));
+      acc0 = _mm256_add_ps(acc0, acc1);
+      __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+      half = _mm_hadd_ps(half, half);
+      half = _mm_hadd_ps(half, half);
+      result = _mm_cvtss_f32(half);
+    }
+    else if constexpr (std::is_same_v<T, double>) {
+      __m256d acc0 = _mm256_setzero_pd();
+      __m256d acc1 = _mm256_setzero_pd();
+      for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(data + i + 4));
+      }
+      for (; i + 4 <= n; i += 4)
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+      acc0 = _mm256_add_pd(acc0, acc1);
+      __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+      result = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+    else if constexpr (std::is_same_v<T, int32_t>) {
+      __m256i acc = _mm256_setzero_si256();
+      for (; i + 8 <= n; i += 8)
+        acc = _mm256_add_epi32(acc, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i)));
+      __m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+      half = _mm_hadd_epi32(half, half);
+      half = _mm_hadd_epi32(half, half);
+      result = _mm_cvtsi128_si32(half);
+    }
+#elif defined(DEQUE_SIMD_NEON)
+    if constexpr (std::is_same_v<T, float>) {
+      float32x4_t acc = vdupq_n_f32(0.0f);
+      for (; i + 4 <= n; i += 4)
+        acc = vaddq_f32(acc, vld1q_f32(data + i));
+      result = vaddvq_f32(acc);
+    }
+    else if constexpr (std::is_same_v<T, int32_t>) {
+      int32x4_t acc = vdupq_n_s32(0);
+      for (; i + 4 <= n; i += 4)
+        acc = vaddq_s32(acc, vld1q_s32(data + i));
+      result = vaddvq_s32(acc);
+    }
+#endif
+
+    for (; i < n; ++i)
+      result += data[i];
+    return result;
+  }
+
+  /**
+   * @brief Update minimum and maximum with elements of contiguous segment
+   * @param[in] segment elements to check
+   * @param[in,out] lo the minimum
+   * @param[in,out] hi the maximum
+   * @warning the result is unspecified if there are NaNs
+   */
+  template <typename T>
+  void MinMaxSegment(std::span<T const> segment, T& lo, T& hi) {
+    static_assert(std::is_arithmetic_v<T>, "MinMaxSegment requires arithmetic T");
+    T const* data = segment.data();
+    size_t n = segment.size();
+    size_t i = 0;
+
+#if defined(DEQUE_SIMD_AVX2)
+    if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, int32_t>) {
+      constexpr size_t lanes = 32 / sizeof(T);
+      if (n >= lanes) {
+        alignas(32) T loLanes[lanes];
+        alignas(32) T hiLanes[lanes];
+        if constexpr (std::is_same_v<T, float>) {
+          __m256 vlo = _mm256_set1_ps(lo);
+          __m256 vhi = _mm256_set1_ps(hi);
+          for (; i + lanes <= n; i += lanes) {
+            __m256 v = _mm256_loadu_ps(data + i);
+            vlo = _mm256_min_ps(vlo, v);
+            vhi = _mm256_max_ps(vhi, v);
+          }
+          _mm256_store_ps(loLanes, vlo);
+          _mm256_store_ps(hiLanes, vhi);
+        }
+        else if constexpr (std::is_same_v<T, double>) {
+          __m256d vlo = _mm256_set1_pd(lo);
+          __m256d vhi = _mm256_set1_pd(hi);
+          for (; i + lanes <= n; i += lanes) {
+            __m256d v = _mm256_loadu_pd(data + i);
+            vlo = _mm256_min_pd(vlo, v);
+            vhi = _mm256_max_pd(vhi, v);
+          }
+          _mm256_store_pd(loLanes, vlo);
+          _mm256_store_pd(hiLanes, vhi);
+        }
+        else {
+          __m256i vlo = _mm256_set1_epi32(lo);
+          __m256i vhi = _mm256_set1_epi32(hi);
+          for (; i + lanes <= n; i += lanes) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i));
+            vlo = _mm256_min_epi32(vlo, v);
+            vhi = _mm256_max_epi32(vhi, v);
+          }
+          _mm256_store_si256(reinterpret_cast<__m256i*>(loLanes), vlo);
+          _mm256_store_si256(reinterpret_cast<__m256i*>(hiLanes), vhi);
+        }
+        for (size_t lane = 0; lane < lanes; ++lane) {
+          lo = loLanes[lane] < lo ? loLanes[lane] : lo;
+          hi = hi < hiLanes[lane] ? hiLanes[lane] : hi;
+        }
+      }
+    }
+#elif defined(DEQUE_SIMD_NEON)
+    if constexpr (std::is_same_v<T, float>) {
+      if (n >= 4) {
+        float32x4_t vlo = vdupq_n_f32(lo);
+        float32x4_t vhi = vdupq_n_f32(hi);
+        for (; i + 4 <= n; i += 4) {
+          float32x4_t v = vld1q_f32(data + i);
+          vlo = vminq_f32(vlo, v);
+          vhi = vmaxq_f32(vhi, v);
+        }
+        lo = vminvq_f32(vlo);
+        hi = vmaxvq_f32(vhi);
+      }
+    }
+    else if constexpr (std::is_same_v<T, int32_t>) {
+      if (n >= 4) {
+        int32x4_t vlo = vdupq_n_s32(lo);
+        int32x4_t vhi = vdupq_n_s32(hi);
+        for (; i + 4 <= n; i += 4) {
+          int32x4_t v = vld1q_s32(data + i);
+          vlo = vminq_s32(vlo, v);
+          vhi = vmaxq_s32(vhi, v);
+        }
+        lo = vminvq_s32(vlo);
+        hi = vmaxvq_s32(vhi);
+      }
+    }
+#endif
+
+    for (; i < n; ++i) {
+      lo = data[i] < lo ? data[i] : lo;
+      hi = hi < data[i] ? data[i] : hi;
+    }
+  }
+
+  /**
+   * @brief Find element in contiguous segment
+   * @param[in] segment elements to search in
+   * @param[in] value element to find
+   * @return index of the first element equal to 'value' (segment size if there is none)
+   */
+  template <typename T>
+  size_t FindSegment(std::span<T const> segment, T const& value) {
+    static_assert(std::is_arithmetic_v<T>, "FindSegment requires arithmetic T");
+    T const* data = segment.data();
+    size_t n = segment.size();
+    size_t i = 0;
+
+#if defined(DEQUE_SIMD_AVX2)
+    if constexpr (std::is_same_v<T, float>) {
+      __m256 key = _mm256_set1_ps(value);
+      for (; i + 8 <= n; i += 8) {
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), key, _CMP_EQ_OQ));
+        if (mask != 0)
+          return i + std::countr_zero(mask);
+      }
+    }
+    else if constexpr (std::is_same_v<T, double>) {
+      __m256d key = _mm256_set1_pd(value);
+      for (; i + 4 <= n; i += 4) {
+        unsigned mask = (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i), key, _CMP_EQ_OQ));
+        if (mask != 0)
+          return i + std::countr_zero(mask);
+      }
+    }
+    else if constexpr (std::is_same_v<T, int32_t>) {
+      __m256i key = _mm256_set1_epi32(value);
+      for (; i + 8 <= n; i += 8) {
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i)), key);
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(eq));
+        if (mask != 0)
+          return i + std::countr_zero(mask);
+      }
+    }
+#elif defined(DEQUE_SIMD_NEON)
+    if constexpr (std::is_same_v<T, float>) {
+      float32x4_t key = vdupq_n_f32(value);
+      for (; i + 4 <= n; i += 4)
+        if (vmaxvq_u32(vceqq_f32(vld1q_f32(data + i), key)) != 0)
+          break;
+    }
+    else if constexpr (std::is_same_v<T, int32_t>) {
+      int32x4_t key = vdupq_n_s32(value);
+      for (; i + 4 <= n; i += 4)
+        if (vmaxvq_u32(vceqq_s32(vld1q_s32(data + i), key)) != 0)
+          break;
+    }
+#endif
+
+    for (; i < n; ++i)
+      if (data[i] == value)
+        return i;
+    return n;
+  }
+
+  /**
+   * @brief Count elements in contiguous segment
+   * @param[in] segment elements to check
+   * @param[in] value element to count
+   * @return number of elements equal to 'value'
+   */
+  template <typename T>
+  size_t CountSegment(std::span<T const> segment, T const& value) {
+    static_assert(std::is_arithmetic_v<T>, "CountSegment requires arithmetic T");
+    T const* data = segment.data();
+    size_t n = segment.size();
+    size_t i = 0;
+    size_t result = 0;
+
+#if defined(DEQUE_SIMD_AVX2)
+    if constexpr (std::is_same_v<T, float>) {
+      __m256 key = _mm256_set1_ps(value);
+      for (; i + 8 <= n; i += 8)
+        result += std::popcount((unsigned)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), key, _CMP_EQ_OQ)));
+    }
+    else if constexpr (std::is_same_v<T, double>) {
+      __m256d key = _mm256_set1_pd(value);
+      for (; i + 4 <= n; i += 4)
+        result += std::popcount((unsigned)_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i), key, _CMP_EQ_OQ)));
+    }
+    else if constexpr (std::is_same_v<T, int32_t>) {
+      __m256i key = _mm256_set1_epi32(value);
+      for (; i + 8 <= n; i += 8) {
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i)), key);
+        result += std::popcount((unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+      }
+    }
+#elif defined(DEQUE_SIMD_NEON)
+    if constexpr (std::is_same_v<T, float> || std::is_same_v<T, int32_t>) {
+      // matching lanes are all ones, i.e. -1, so subtracting counts them
+      uint32x4_t acc = vdupq_n_u32(0);
+      for (; i + 4 <= n; i += 4) {
+        if constexpr (std::is_same_v<T, float>)
+          acc = vsubq_u32(acc, vceqq_f32(vld1q_f32(data + i), vdupq_n_f32(value)));
+        else
+          acc = vsubq_u32(acc, vceqq_s32(vld1q_s32(data + i), vdupq_n_s32(value)));
+      }
+      result = vaddvq_u32(acc);
+    }
+#endif
+
+    for (; i < n; ++i)
+      result += data[i] == value;
+    return result;
+  }
+
+  /**
+   * @brief Assign value to all elements of contiguous segment
+   *
+   * Plain contiguous store loop, compilers turn it into vector stores.
+   *
+   * @param[in] segment elements to assign
+   * @param[in] value value to assign
+   */
+  template <typename T>
+  void FillSegment(std::span<T> segment, T const& value) {
+    std::fill_n(segment.data(), segment.size(), value);
+  }
+
+  /**
+   * @brief Sum elements of deque
+   * @param[in] deque deque with ForEachSegment()
+   * @return sum of the elements (zero for empty deque)
+   */
+  template <typename Deque>
+  element_t<Deque> Sum(Deque const& deque) {
+    using T = element_t<Deque>;
+    T result = T();
+    deque.ForEachSegment([&](std::span<T const> segment) { result += SumSegment(segment); });
+    return result;
+  }
+
+  /**
+   * @brief Find minimum and maximum of deque
+   * @param[in] deque deque with ForEachSegment()
+   * @return pair of the minimum and the maximum
+   * @warning deque must not be empty
+   */
+  template <typename Deque>
+  std::pair<element_t<Deque>, element_t<Deque>> MinMax(Deque const& deque) {
+    using T = element_t<Deque>;
+    T lo = deque.Front();
+    T hi = lo;
+    deque.ForEachSegment([&](std::span<T const> segment) { MinMaxSegment(segment, lo, hi); });
+    return std::make_pair(lo, hi);
+  }
+
+  /**
+   * @brief Find element in deque
+   * @param[in] deque deque with ForEachSegment() and random-access iterators
+   * @param[in] value element to find
+   * @return iterator to the first element equal to 'value' (end() if there is none)
+   */
+  template <typename Deque>
+  auto Find(Deque& deque, element_t<Deque> const& value) {
+    using T = element_t<Deque>;
+    size_t index = 0;
+    bool found = false;
+    std::as_const(deque).ForEachSegment([&](std::span<T const> segment) {
+      if (found)
+        return;
+      size_t i = FindSegment(segment, value);
+      index += i;
+      found = i != segment.size();
+    });
+    return deque.begin() + index;
+  }
+
+  /**
+   * @brief Count elements of deque
+   * @param[in] deque deque with ForEachSegment()
+   * @param[in] value element to count
+   * @return number of elements equal to 'value'
+   */
+  template <typename Deque>
+  size_t Count(Deque const& deque, element_t<Deque> const& value) {
+    using T = element_t<Deque>;
+    size_t result = 0;
+    deque.ForEachSegment([&](std::span<T const> segment) { result += CountSegment(segment, value); });
+    return result;
+  }
+
+  /**
+   * @brief Assign value to all elements of deque
+   * @param[in] deque deque with ForEachSegment()
+   * @param[in] value value to assign
+   */
+  template <typename Deque>
+  void Fill(Deque& deque, element_t<Deque> const& value) {
+    using T = element_t<Deque>;
+    deque.ForEachSegment([&](std::span<T> segment) { FillSegment(segment, value); });
+  }
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Snapshot of deque statistics
+ *
+ * Element operations are counted: pushBack + pushFront + insert - popBack - popFront - erase
+ * is the size of a deque changed by them only. Whole-deque operations (construction,
+ * assignment, Clear(), SpliceBack/SpliceFront) are not counted.
+ */
+struct deque_stats_t {
+  static constexpr size_t latencyBuckets = 32;  ///< number of latency histogram buckets
+
+  uint64_t pushBack = 0;            ///< number of elements pushed to the end
+  uint64_t pushFront = 0;           ///< number of elements pushed to the begin
+  uint64_t popBack = 0;             ///< number of elements popped from the end
+  uint64_t popFront = 0;            ///< number of elements popped from the begin
+  uint64_t insert = 0;              ///< number of elements inserted in the middle (Emplace, Insert, received by SplitAt)
+  uint64_t erase = 0;               ///< number of elements removed from the middle (Erase, Extract, given away by SplitAt)
+  uint64_t allocations = 0;         ///< number of allocator calls for nodes
+  uint64_t deallocations = 0;       ///< number of deallocator calls for nodes
+  size_t peakSize = 0;              ///< maximum size of the deque
+  uint64_t latencySamples = 0;      ///< number of timed pushes
+  uint64_t latency[latencyBuckets] = {};  ///< timed pushes by duration, bucket i counts durations in [2^(i-1), 2^i) ns
+};
+
+/**
+ * @brief Statistics policy collecting nothing
+ *
+ * All hooks are empty and the policy has no members, so a deque with it
+ * has the same size and code as without statistics.
+ */
+struct deque_stats_off {
+  /**
+   * @brief Timer token of a push
+   */
+  struct timer_t {};
+
+  void OnPushBack(size_t, size_t) {}
+  void OnPushFront(size_t, size_t) {}
+  void OnPopBack(size_t) {}
+  void OnPopFront(size_t) {}
+  void OnInsert(size_t, size_t) {}
+  void OnErase(size_t) {}
+  void OnAllocate() {}
+  void OnDeallocate() {}
+  void OnSize(size_t) {}
+  timer_t StartTimer() { return timer_t(); }
+  void StopTimer(timer_t) {}
+
+  /**
+   * @brief Get collected statistics
+   * @return empty snapshot
+   */
+  deque_stats_t Snapshot() const {
+    return deque_stats_t();
+  }
+};
+
+/**
+ * @brief Statistics policy with counters
+ *
+ * Counts pushes and pops per end, allocator calls and tracks the peak size.
+ * Counters are plain integers, as the deque itself is not thread-safe.
+ */
+struct deque_stats_on {
+  /**
+   * @brief Timer token of a push
+   */
+  struct timer_t {};
+
+protected:
+  deque_stats_t stats;              ///< collected statistics
+
+public:
+  /**
+   * @brief Count elements pushed to the end
+   * @param[in] count number of pushed elements
+   * @param[in] size size of the deque after the push
+   */
+  void OnPushBack(size_t count, size_t size) {
+    stats.pushBack += count;
+    OnSize(size);
+  }
+
+  /**
+   * @brief Count elements pushed to the begin
+   * @param[in] count number of pushed elements
+   * @param[in] size size of the deque after the push
+   */
+  void OnPushFront(size_t count, size_t size) {
+    stats.pushFront += count;
+    OnSize(size);
+  }
+
+  /**
+   * @brief Count elements popped from the end
+   * @param[in] count number of popped elements
+   */
+  void OnPopBack(size_t count) {
+    stats.popBack += count;
+  }
+
+  /**
+   * @brief Count elements popped from the begin
+   * @param[in] count number of popped elements
+   */
+  void OnPopFront(size_t count) {
+    stats.popFront += count;
+  }
+
+  /**
+   * @brief Count elements inserted in the middle
+   * @param[in] count number of inserted elements
+   * @param[in] size size of the deque after the insert
+   */
+  void OnInsert(size_t count, size_t size) {
+    stats.insert += count;
+    OnSize(size);
+  }
+
+  /**
+   * @brief Count elements removed from the middle
+   * @param[in] count number of removed elements
+   */
+  void OnErase(size_t count) {
+    stats.erase += count;
+  }
+
+  /**
+   * @brief Count allocator call
+   */
+  void OnAllocate() {
+    ++stats.allocations;
+  }
+
+  /**
+   * @brief Count deallocator call
+   */
+  void OnDeallocate() {
+    ++stats.deallocations;
+  }
+
+  /**
+   * @brief Update peak size
+   * @param[in] size current size of the deque
+   */
+  void OnSize(size_t size) {
+    stats.peakSize = size > stats.peakSize ? size : stats.peakSize;
+  }
+
+  timer_t StartTimer() { return timer_t(); }
+  void StopTimer(timer_t) {}
+
+  /**
+   * @brief Get collected statistics
+   * @return copy of the statistics
+   */
+  deque_stats_t Snapshot() const {
+    return stats;
+  }
+};
+
+/**
+ * @brief Statistics policy with counters and sampled push latency
+ *
+ * Every 'SamplePeriod'-th push is timed with std::chrono::steady_clock and put to
+ * a log2 histogram, so the clock is read for a small part of pushes only.
+ *
+ * @tparam SamplePeriod number of pushes per timed one (power of two)
+ */
+template <unsigned SamplePeriod = 64>
+struct deque_stats_sampled : deque_stats_on {
+  static_assert(SamplePeriod > 0 && (SamplePeriod & (SamplePeriod - 1)) == 0, "SamplePeriod must be a power of two");
+
+  /**
+   * @brief Timer token of a push
+   */
+  struct timer_t {
+    int64_t start;            ///< start time in ns (negative if the push is not sampled)
+  };
+
+private:
+  unsigned pushes = 0;        ///< number of started timers modulo the period
+
+public:
+  /**
+   * @brief Start timing push if it is sampled
+   * @return timer token
+   */
+  timer_t StartTimer() {
+    if ((pushes++ & (SamplePeriod - 1)) != 0)
+      return timer_t{ -1 };
+    return timer_t{ Now() };
+  }
+
+  /**
+   * @brief Finish timing push
+   * @param[in] timer token returned by StartTimer()
+   */
+  void StopTimer(timer_t timer) {
+    if (timer.start < 0)
+      return;
+
+    uint64_t elapsed = (uint64_t)(Now() - timer.start);
+    size_t bucket = (size_t)std::bit_width(elapsed);
+    ++stats.latency[bucket < deque_stats_t::latencyBuckets ? bucket : deque_stats_t::latencyBuckets - 1];
+    ++stats.latencySamples;
+  }
+
+private:
+  /**
+   * @brief Read the clock
+   * @return current time in ns
+   */
+  static int64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+};
@@ -0,0 +1,562 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+/**
+ * @brief Hook of elements of intrusive_deque_t, a base class of the element
+ *
+ * Both links are null while the element is not in a deque.
+ */
+class deque_hook_t {
+public:
+  deque_hook_t* prev;         ///< pointer to previous hook (the sentinel if the element is the first)
+  deque_hook_t* next;         ///< pointer to next hook (the sentinel if the element is the last)
+
+  /**
+   * @brief Constructor of unlinked hook
+   */
+  deque_hook_t() : prev(nullptr), next(nullptr) {};
+
+  /**
+   * @brief Copy constructor
+   *
+   * A copy of a linked element is not linked.
+   */
+  deque_hook_t(deque_hook_t const&) : prev(nullptr), next(nullptr) {};
+
+  /**
+   * @brief Copy assignment
+   *
+   * The links of the element are kept.
+   *
+   * @return reference to this hook
+   */
+  deque_hook_t& operator=(deque_hook_t const&) {
+    return *this;
+  }
+
+  /**
+   * @brief Check is element in a deque
+   * @return true if the hook is linked, false otherwise
+   */
+  bool IsLinked() const {
+    return next != nullptr;
+  }
+};
+
+/**
+ * @brief Hook distinguished by tag, for elements in several intrusive deques at once
+ *
+ * An element derives from one tagged hook per deque it can be in.
+ *
+ * @tparam Tag any type naming the hook
+ */
+template <typename Tag>
+class deque_tagged_hook_t : public deque_hook_t {};
+
+/**
+ * @brief Intrusive deque class
+ *
+ * Deque of objects owned elsewhere: the links live in a deque_hook_t base of the
+ * element, so pushing allocates and copies nothing, and an element is erased in O(1)
+ * by reference. The deque owns no memory; destroying or clearing it only unlinks the elements.
+ * An element may be in several deques at once through different deque_tagged_hook_t bases.
+ *
+ * The hook is a base class, not a member: the element is found from its hook with
+ * static_cast, which is defined for any 'T' (a member would need offsetof arithmetic).
+ *
+ * @tparam T type of elements
+ * @tparam Hook base of 'T' used by this deque (deque_hook_t or deque_tagged_hook_t, not a virtual base)
+ * @warning an element must outlive its stay in the deque
+ */
+template <typename T, typename Hook = deque_hook_t>
+class intrusive_deque_t {
+  static_assert(std::is_base_of<deque_hook_t, Hook>::value, "Hook must be deque_hook_t or derived from it");
+  static_assert(std::is_base_of<Hook, T>::value, "T must derive from Hook");
+
+private:
+  deque_hook_t sentinel;      ///< 'next' is the first hook, 'prev' is the last hook (both the sentinel itself if the deque is empty)
+  size_t size;                ///< size in elements in the deque
+
+  /**
+   * @brief Get hook of element
+   * @param[in] element the element
+   * @return pointer to the hook used by this deque
+   */
+  static deque_hook_t* HookOf(T& element) {
+    return static_cast<deque_hook_t*>(static_cast<Hook*>(&element));
+  }
+
+  /**
+   * @brief Get element of hook
+   * @param[in] hook hook of the element (must not be the sentinel)
+   * @return pointer to the element
+   */
+  static T* ElementOf(deque_hook_t* hook) {
+    return static_cast<T*>(static_cast<Hook*>(hook));
+  }
+
+  /**
+   * @brief Deque iterator class
+   * @tparam IsConst const's of this iterator
+   */
+  template<bool IsConst>
+  class common_iterator {
+    friend class intrusive_deque_t;
+    template <bool> friend class common_iterator;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, T const*, T*>;
+    using reference = std::conditional_t<IsConst, T const&, T&>;
+
+  private:
+    deque_hook_t* data;         ///< pointer to hook of element (the sentinel for end iterator)
+  private:
+    /**
+     * @brief Constructor from pointer to hook
+     * @param[in] data pointer to hook
+     */
+    explicit common_iterator(deque_hook_t* data) : data(data) {};
+
+  public:
+    /**
+     * @brief Default constructor
+     */
+    common_iterator() : data(nullptr) {};
+
+    /**
+     * @brief Conversion from non-const iterator
+     * @param[in] other iterator to convert
+     */
+    template <bool WasConst, typename = std::enable_if_t<IsConst && !WasConst>>
+    common_iterator(common_iterator<WasConst> const& other) : data(other.data) {};
+
+    /**
+     * @brief Dereference operator *
+     * @return reference (const reference for const iterator) to the pointed-to element
+     */
+    reference operator*() const {
+      return *ElementOf(data);
+    }
+
+    /**
+     * @brief Dereference operator ->
+     * @return pointer (const pointer for const iterator) to the pointed-to element
+     */
+    pointer operator->() const {
+      return ElementOf(data);
+    }
+
+    /**
+     * @brief Prefix increment
+     * @return reference to this iterator
+     */
+    common_iterator& operator++() {
+      data = data->next;
+      return *this;
+    }
+
+    /**
+     * @brief Postfix increment
+     * @return previous value of this iterator
+     */
+    common_iterator operator++(int) {
+      common_iterator tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    /**
+     * @brief Prefix decrement
+     * @return reference to this iterator
+     */
+    common_iterator& operator--() {
+      data = data->prev;
+      return *this;
+    }
+
+    /**
+     * @brief Postfix decrement
+     * @return previous value of this iterator
+     */
+    common_iterator operator--(int) {
+      common_iterator tmp = *this;
+      --(*this);
+      return tmp;
+    }
+
+    /**
+     * @brief Equality operator
+     * @param[in] other iterator to compare
+     * @return true if iterators point to the same element else false
+     */
+    bool operator==(common_iterator const& other) const {
+      return this->data == other.data;
+    }
+
+    /**
+     * @brief Inequality operator
+     * @param[in] other iterator to compare
+     * @return true if iterators point to the different elements else false
+     */
+    bool operator!=(common_iterator const& other) const {
+      return !(this->data == other.data);
+    }
+  };
+
+  /**
+   * @brief Get end link
+   * @return pointer to the sentinel
+   */
+  deque_hook_t* End() const {
+    return const_cast<deque_hook_t*>(&sentinel);
+  }
+
+  /**
+   * @brief Make deque empty without touching elements
+   */
+  void ResetLinks() {
+    sentinel.prev = &sentinel;
+    sentinel.next = &sentinel;
+    size = 0;
+  }
+
+  /**
+   * @brief Link hook between two neighbours
+   * @param[in] hook hook to link
+   * @param[in] prev hook to be before it
+   * @param[in] next hook to be after it
+   */
+  static void Link(deque_hook_t* hook, deque_hook_t* prev, deque_hook_t* next) {
+    hook->prev = prev;
+    hook->next = next;
+    prev->next = hook;
+    next->prev = hook;
+  }
+
+  /**
+   * @brief Unlink hook from its neighbours and reset it
+   * @param[in] hook linked hook
+   */
+  static void Unlink(deque_hook_t* hook) {
+    hook->prev->next = hook->next;
+    hook->next->prev = hook->prev;
+    hook->prev = nullptr;
+    hook->next = nullptr;
+  }
+
+public:
+  using iterator = common_iterator<false>;
+  using const_iterator = common_iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  /**
+   * @brief Constructor of empty deque
+   */
+  intrusive_deque_t() {
+    ResetLinks();
+  };
+
+  intrusive_deque_t(intrusive_deque_t const&) = delete;
+  intrusive_deque_t& operator=(intrusive_deque_t const&) = delete;
+
+  /**
+   * @brief Move constructor
+   *
+   * The elements are relinked to this deque, 'other' becomes empty.
+   *
+   * @param[in] other deque to take elements from
+   */
+  intrusive_deque_t(intrusive_deque_t&& other) noexcept {
+    ResetLinks();
+    Swap(other);
+  }
+
+  /**
+   * @brief Move assignment
+   *
+   * The elements of this deque are unlinked.
+   *
+   * @param[in] other deque to take elements from
+   * @return reference to this deque
+   */
+  intrusive_deque_t& operator=(intrusive_deque_t&& other) noexcept {
+    if (this != &other) {
+      Clear();
+      Swap(other);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Swap elements with other deque
+   * @param[in] other deque to swap with
+   */
+  void Swap(intrusive_deque_t& other) noexcept {
+    deque_hook_t* first = sentinel.next;
+    deque_hook_t* last = sentinel.prev;
+    size_t count = size;
+    bool wasEmpty = first == &sentinel;
+
+    if (other.sentinel.next == &other.sentinel)
+      ResetLinks();
+    else {
+      sentinel.next = other.sentinel.next;
+      sentinel.prev = other.sentinel.prev;
+      sentinel.next->prev = &sentinel;
+      sentinel.prev->next = &sentinel;
+      size = other.size;
+    }
+
+    if (wasEmpty)
+      other.ResetLinks();
+    else {
+      other.sentinel.next = first;
+      other.sentinel.prev = last;
+      first->prev = &other.sentinel;
+      last->next = &other.sentinel;
+      other.size = count;
+    }
+  }
+
+  /**
+   * @brief Check is deque empty method
+   * @return true if deque is empty, false otherwise
+   */
+  bool IsEmpty() const {
+    return sentinel.next == &sentinel;
+  }
+
+  /**
+   * @brief Get deque size method
+   * @return number of elements in the deque
+   */
+  size_t Size() const {
+    return size;
+  }
+
+  /**
+   * @brief Get the first element
+   * @return reference to the first element
+   * @warning deque must not be empty
+   */
+  T& Front() {
+    return *ElementOf(sentinel.next);
+  }
+
+  /**
+   * @brief Get the first element
+   * @return const reference to the first element
+   * @warning deque must not be empty
+   */
+  T const& Front() const {
+    return *ElementOf(sentinel.next);
+  }
+
+  /**
+   * @brief Get the last element
+   * @return reference to the last element
+   * @warning deque must not be empty
+   */
+  T& Back() {
+    return *ElementOf(sentinel.prev);
+  }
+
+  /**
+   * @brief Get the last element
+   * @return const reference to the last element
+   * @warning deque must not be empty
+   */
+  T const& Back() const {
+    return *ElementOf(sentinel.prev);
+  }
+
+  /**
+   * @brief Method link element to end of deque
+   * @param[in] element element to add (its hook must not be linked)
+   */
+  void PushBack(T& element) {
+    Link(HookOf(element), sentinel.prev, &sentinel);
+    ++size;
+  }
+
+  /**
+   * @brief Method link element to begin of deque
+   * @param[in] element element to add (its hook must not be linked)
+   */
+  void PushFront(T& element) {
+    Link(HookOf(element), &sentinel, sentinel.next);
+    ++size;
+  }
+
+  /**
+   * @brief Link element before given position
+   * @param[in] pos iterator before which the element is linked
+   * @param[in] element element to add (its hook must not be linked)
+   * @return iterator pointing to the element
+   */
+  iterator Insert(const_iterator pos, T& element) {
+    deque_hook_t* hook = HookOf(element);
+    Link(hook, pos.data->prev, pos.data);
+    ++size;
+    return iterator(hook);
+  }
+
+  /**
+   * @brief Unlink the last element
+   */
+  void PopBack() {
+    if (size == 0)
+      return;
+    Unlink(sentinel.prev);
+    --size;
+  }
+
+  /**
+   * @brief Unlink the first element
+   */
+  void PopFront() {
+    if (size == 0)
+      return;
+    Unlink(sentinel.next);
+    --size;
+  }
+
+  /**
+   * @brief Unlink element
+   * @param[in] element element of this deque
+   * @warning the element must be in this deque
+   */
+  void Erase(T& element) {
+    Unlink(HookOf(element));
+    --size;
+  }
+
+  /**
+   * @brief Unlink element at position
+   * @param[in] pos iterator pointing to element of this deque
+   * @return iterator pointing to the next element
+   */
+  iterator Erase(const_iterator pos) {
+    deque_hook_t* next = pos.data->next;
+    Unlink(pos.data);
+    --size;
+    return iterator(next);
+  }
+
+  /**
+   * @brief Get iterator to element
+   * @param[in] element element of this deque
+   * @return iterator pointing to the element
+   */
+  iterator IteratorTo(T& element) {
+    return iterator(HookOf(element));
+  }
+
+  /**
+   * @brief Get const iterator to element
+   * @param[in] element element of this deque
+   * @return const iterator pointing to the element
+   */
+  const_iterator IteratorTo(T const& element) const {
+    return const_iterator(HookOf(const_cast<T&>(element)));
+  }
+
+  /**
+   * @brief Begin of deque
+   * @return iterator pointed to the first element of deque
+   */
+  iterator begin() noexcept {
+    return iterator(sentinel.next);
+  }
+
+  /**
+   * @brief End of deque
+   * @return iterator pointed to the next after last element of deque
+   * @warning dereferencing can cause undefined behaviour
+   */
+  iterator end() noexcept {
+    return iterator(End());
+  }
+
+  /**
+   * @brief Begin of deque
+   * @return const iterator pointed to the first element of deque
+   */
+  const_iterator begin() const noexcept {
+    return const_iterator(sentinel.next);
+  }
+
+  /**
+   * @brief End of deque
+   * @return const iterator pointed to the next after last element of deque
+   * @warning dereferencing can cause undefined behaviour
+   */
+  const_iterator end() const noexcept {
+    return const_iterator(End());
+  }
+
+  /**
+   * @brief Reverse begin of deque
+   * @return reverse iterator pointed to the last element of deque
+   */
+  reverse_iterator rbegin() noexcept {
+    return reverse_iterator(end());
+  }
+
+  /**
+   * @brief Reverse end of deque
+   * @return reverse iterator pointed to the before first element of deque
+   */
+  reverse_iterator rend() noexcept {
+    return reverse_iterator(begin());
+  }
+
+  /**
+   * @brief Begin of deque
+   * @return const iterator pointed to the first element of deque
+   */
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+
+  /**
+   * @brief End of deque
+   * @return const iterator pointed to the next after last element of deque
+   * @warning dereferencing can cause undefined behaviour
+   */
+  const_iterator cend() const noexcept {
+    return end();
+  }
+
+  /**
+   * @brief Clear deque
+   *
+   * Hooks of all elements are reset, the elements themselves are not touched.
+   */
+  void Clear() {
+    deque_hook_t* hook = sentinel.next;
+    while (hook != &sentinel) {
+      deque_hook_t* next = hook->next;
+      hook->prev = nullptr;
+      hook->next = nullptr;
+      hook = next;
+    }
+    ResetLinks();
+  }
+
+  /**
+   * @brief Deque destructor
+   *
+   * Unlinks the elements, so they can be put to other deques.
+   */
+  ~intrusive_deque_t() {
+    Clear();
+  }
+};
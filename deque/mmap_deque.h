@@ -0,0 +1,391 @@
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Memory-mapped deque class
+ *
+ * Queue stored in a memory-mapped file, so it can exceed RAM and survives restarts.
+ * The file holds a header and fixed-size blocks of elements; blocks are linked
+ * by file offsets, not pointers, so reopening the file (mapped to any address)
+ * restores the deque without deserialization. Emptied blocks go to a free list in
+ * the file and are reused; the file grows twice when there is no free block.
+ *
+ * Data reaches the disk when the system writes the pages back or on Flush(). The file is
+ * consistent after Flush() only: the system writes pages back in any order, so after a system
+ * crash between flushes the header and the blocks may disagree and the file may be unusable.
+ * A crash of the process alone loses nothing, the pages stay in the page cache.
+ * Available on POSIX systems only.
+ *
+ * @tparam T type of stored elements (must be trivially copyable)
+ */
+template <typename T>
+class mmap_deque_t {
+  static_assert(std::is_trivially_copyable<T>::value, "mmap_deque_t requires trivially copyable T");
+  static_assert(alignof(T) <= 16, "mmap_deque_t requires alignment of T not more than 16");
+
+private:
+  static constexpr uint64_t magic = 0x45555145444d4d41ull;  ///< "AMMDEQUE" file signature
+  static constexpr uint32_t version = 1;                    ///< file format version
+  static constexpr uint64_t headerBytes = 4096;             ///< space reserved for the header at the beginning of the file
+  static constexpr uint64_t initialBlocks = 4;              ///< number of blocks in a new file
+
+  /**
+   * @brief File header
+   */
+  struct header_t {
+    uint64_t magic;           ///< file signature
+    uint32_t version;         ///< file format version
+    uint32_t elementSize;     ///< sizeof(T) of the deque which created the file
+    uint64_t blockBytes;      ///< size of one block in bytes
+    uint64_t fileSize;        ///< size of the file in bytes
+    uint64_t usedEnd;         ///< offset after the last block ever allocated
+    uint64_t freeBlocks;      ///< offset of the first free block (0 if none)
+    uint64_t headBlock;       ///< offset of the block with the first element (0 if no block)
+    uint64_t headIndex;       ///< index of the first element in its block
+    uint64_t tailBlock;       ///< offset of the block with the last element (0 if no block)
+    uint64_t tailIndex;       ///< index after the last element in its block
+    uint64_t size;            ///< size in elements in the deque
+  };
+
+  /**
+   * @brief Block header, elements follow it
+   */
+  struct block_t {
+    uint64_t next;            ///< offset of the next block (0 if the block is the last)
+    uint64_t reserved;        ///< keeps elements 16-byte aligned
+  };
+
+  int fd;                     ///< file descriptor
+  char* base;                 ///< address the file is mapped to
+  size_t mapped;              ///< size of the mapping in bytes
+  size_t perBlock;            ///< number of elements in one block
+
+  /**
+   * @brief Get file header
+   * @return pointer to the header
+   */
+  header_t* Header() const {
+    return reinterpret_cast<header_t*>(base);
+  }
+
+  /**
+   * @brief Get block by offset
+   * @param[in] offset offset of the block in the file
+   * @return pointer to the block
+   */
+  block_t* Block(uint64_t offset) const {
+    return reinterpret_cast<block_t*>(base + offset);
+  }
+
+  /**
+   * @brief Get element of block
+   * @param[in] offset offset of the block in the file
+   * @param[in] index index of the element in the block
+   * @return pointer to the element
+   */
+  T* Element(uint64_t offset, uint64_t index) const {
+    return reinterpret_cast<T*>(base + offset + sizeof(block_t)) + index;
+  }
+
+  /**
+   * @brief Throw exception for failed system call
+   * @param[in] what name of the failed call
+   */
+  [[noreturn]] static void ThrowError(char const* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  /**
+   * @brief Map given number of bytes of the file
+   * @param[in] bytes size of the mapping
+   * @return address of the mapping
+   */
+  char* Map(uint64_t bytes) {
+    void* address = ::mmap(nullptr, (size_t)bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED)
+      ThrowError("mmap");
+    return static_cast<char*>(address);
+  }
+
+  /**
+   * @brief Enlarge file twice and map it again
+   *
+   * The new mapping is made before the old one is removed, so the deque stays
+   * usable if the mapping fails. The header is updated last; a file enlarged
+   * without it is accepted by Open().
+   */
+  void Grow() {
+    uint64_t oldSize = Header()->fileSize;
+    uint64_t newSize = oldSize * 2;
+    if (::ftruncate(fd, (off_t)newSize) != 0)
+      ThrowError("ftruncate");
+
+    char* address = Map(newSize);
+    ::munmap(base, (size_t)oldSize);
+    base = address;
+    mapped = (size_t)newSize;
+    Header()->fileSize = newSize;
+  }
+
+  /**
+   * @brief Take block from the free list or the end of the file
+   * @return offset of the block with 'next' set to 0
+   */
+  uint64_t AllocateBlock() {
+    uint64_t offset = Header()->freeBlocks;
+    if (offset != 0)
+      Header()->freeBlocks = Block(offset)->next;
+    else {
+      while (Header()->usedEnd + Header()->blockBytes > Header()->fileSize)
+        Grow();
+      offset = Header()->usedEnd;
+      Header()->usedEnd += Header()->blockBytes;
+    }
+    Block(offset)->next = 0;
+    return offset;
+  }
+
+  /**
+   * @brief Put block to the free list
+   * @param[in] offset offset of the block
+   */
+  void FreeBlock(uint64_t offset) {
+    Block(offset)->next = Header()->freeBlocks;
+    Header()->freeBlocks = offset;
+  }
+
+  /**
+   * @brief Initialize header of new file
+   * @param[in] blockBytes size of one block in bytes
+   */
+  void Create(uint64_t blockBytes) {
+    uint64_t fileSize = headerBytes + initialBlocks * blockBytes;
+    if (::ftruncate(fd, (off_t)fileSize) != 0)
+      ThrowError("ftruncate");
+    base = Map(fileSize);
+    mapped = (size_t)fileSize;
+
+    header_t* header = Header();
+    std::memset(header, 0, sizeof(header_t));
+    header->magic = magic;
+    header->version = version;
+    header->elementSize = sizeof(T);
+    header->blockBytes = blockBytes;
+    header->fileSize = fileSize;
+    header->usedEnd = headerBytes;
+  }
+
+  /**
+   * @brief Map existing file and check its header
+   * @param[in] fileSize size of the file in bytes
+   */
+  void Open(uint64_t fileSize) {
+    if (fileSize < headerBytes)
+      throw std::runtime_error("mmap deque file is truncated");
+    base = Map(fileSize);
+    mapped = (size_t)fileSize;
+
+    header_t* header = Header();
+    if (header->magic != magic || header->version != version || header->elementSize != sizeof(T))
+      throw std::runtime_error("mmap deque file has incompatible format");
+    if (header->fileSize > fileSize)
+      throw std::runtime_error("mmap deque file is truncated");
+    if (header->blockBytes < sizeof(block_t) + sizeof(T) || header->blockBytes % 64 != 0 || header->blockBytes > fileSize - headerBytes
+      || header->usedEnd < headerBytes || header->usedEnd > fileSize)
+      throw std::runtime_error("mmap deque file is corrupt");
+    // larger file is left by Grow() interrupted after ftruncate, adopt its size
+    header->fileSize = fileSize;
+  }
+
+  /**
+   * @brief Unmap and close the file
+   */
+  void Close() {
+    if (base != nullptr)
+      ::munmap(base, mapped);
+    if (fd >= 0)
+      ::close(fd);
+    base = nullptr;
+    fd = -1;
+  }
+
+public:
+  /**
+   * @brief Open deque stored in file, creating the file if it does not exist or is empty
+   * @param[in] path path to the file
+   * @param[in] blockBytes size of one block in a new file (rounded up to 64 bytes; existing files keep theirs)
+   * @throw std::system_error if a system call fails
+   * @throw std::runtime_error if the file was not created by mmap_deque_t of the same 'T' or is corrupt
+   */
+  explicit mmap_deque_t(std::string const& path, size_t blockBytes = 1 << 16) : fd(-1), base(nullptr), mapped(0), perBlock(0) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+      ThrowError("open");
+
+    try {
+      struct stat info;
+      if (::fstat(fd, &info) != 0)
+        ThrowError("fstat");
+
+      if (info.st_size == 0) {
+        uint64_t rounded = ((uint64_t)blockBytes + 63) / 64 * 64;
+        if (rounded < sizeof(block_t) + sizeof(T))
+          rounded = (sizeof(block_t) + sizeof(T) + 63) / 64 * 64;
+        Create(rounded);
+      }
+      else
+        Open((uint64_t)info.st_size);
+    }
+    catch (...) {
+      Close();
+      throw;
+    }
+    perBlock = (size_t)((Header()->blockBytes - sizeof(block_t)) / sizeof(T));
+  }
+
+  mmap_deque_t(mmap_deque_t const&) = delete;
+  mmap_deque_t& operator=(mmap_deque_t const&) = delete;
+
+  /**
+   * @brief Check is deque empty method
+   * @return true if deque is empty, false otherwise
+   */
+  bool IsEmpty() const {
+    return Header()->size == 0;
+  }
+
+  /**
+   * @brief Get deque size method
+   * @return number of elements in the deque
+   */
+  size_t Size() const {
+    return (size_t)Header()->size;
+  }
+
+  /**
+   * @brief Get the first element
+   * @return reference to the first element
+   * @warning deque must not be empty; the reference is invalidated by pushes (the file may be remapped)
+   */
+  T& Front() {
+    return *Element(Header()->headBlock, Header()->headIndex);
+  }
+
+  /**
+   * @brief Get the first element
+   * @return const reference to the first element
+   * @warning deque must not be empty; the reference is invalidated by pushes (the file may be remapped)
+   */
+  T const& Front() const {
+    return *Element(Header()->headBlock, Header()->headIndex);
+  }
+
+  /**
+   * @brief Get the last element
+   * @return reference to the last element
+   * @warning deque must not be empty; the reference is invalidated by pushes (the file may be remapped)
+   */
+  T& Back() {
+    return *Element(Header()->tailBlock, Header()->tailIndex - 1);
+  }
+
+  /**
+   * @brief Get the last element
+   * @return const reference to the last element
+   * @warning deque must not be empty; the reference is invalidated by pushes (the file may be remapped)
+   */
+  T const& Back() const {
+    return *Element(Header()->tailBlock, Header()->tailIndex - 1);
+  }
+
+  /**
+   * @brief Method put element to end of deque
+   * @param[in] value element to add
+   * @throw std::system_error if the file cannot grow
+   */
+  void PushBack(T const& value) {
+    // 'value' may be an element of this deque, which AllocateBlock() can unmap
+    T const copy = value;
+    header_t* header = Header();
+    if (header->tailBlock == 0) {
+      uint64_t block = AllocateBlock();
+      header = Header();
+      header->headBlock = block;
+      header->tailBlock = block;
+      header->headIndex = 0;
+      header->tailIndex = 0;
+    }
+    else if (header->tailIndex == perBlock) {
+      uint64_t block = AllocateBlock();
+      header = Header();
+      Block(header->tailBlock)->next = block;
+      header->tailBlock = block;
+      header->tailIndex = 0;
+    }
+
+    std::memcpy(static_cast<void*>(Element(header->tailBlock, header->tailIndex)), &copy, sizeof(T));
+    ++header->tailIndex;
+    ++header->size;
+  }
+
+  /**
+   * @brief Remove element from the front of deque
+   */
+  void PopFront() {
+    header_t* header = Header();
+    if (header->size == 0)
+      return;
+
+    ++header->headIndex;
+    --header->size;
+    if (header->size == 0) {
+      // keep the only block for the next push
+      header->headIndex = 0;
+      header->tailIndex = 0;
+    }
+    else if (header->headIndex == perBlock) {
+      uint64_t block = header->headBlock;
+      header->headBlock = Block(block)->next;
+      header->headIndex = 0;
+      FreeBlock(block);
+    }
+  }
+
+  /**
+   * @brief Write changed pages to the file
+   *
+   * Returns after the data is on the disk, so the file is consistent until the next change.
+   *
+   * @throw std::system_error if msync fails
+   */
+  void Flush() {
+    if (::msync(base, mapped, MS_SYNC) != 0)
+      ThrowError("msync");
+  }
+
+  /**
+   * @brief Deque destructor
+   *
+   * The file is unmapped without waiting for the disk (see Flush()).
+   */
+  ~mmap_deque_t() {
+    Close();
+  }
+};
+
+#endif
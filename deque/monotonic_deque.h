@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "ring_deque.h"
+
+/**
+ * @brief Monotonic deque class
+ *
+ * Sliding-window extremum: values are pushed with non-decreasing keys (sequence numbers
+ * or timestamps) and evicted by key from the front. A value which can never become the
+ * top again (it is older than a newer value and not greater than it) is dropped on push,
+ * so every value is pushed and popped once and Top() is O(1) amortized. Entries are kept
+ * in a ring_deque_t, so there is no allocation per element.
+ *
+ * @tparam T type of stored values
+ * @tparam Compare ordering of values, Top() is the greatest one (std::less gives maximum, std::greater gives minimum)
+ * @tparam Key type of keys
+ * @tparam Allocator the allocator to be used
+ */
+template <typename T, typename Compare = std::less<T>, typename Key = size_t, typename Allocator = std::allocator<T>>
+class monotonic_deque_t {
+private:
+  /**
+   * @brief Deque entry class
+   */
+  struct entry_t {
+    Key key;                  ///< key of the value
+    T value;                  ///< stored value
+  };
+
+  using entry_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<entry_t>;
+
+  ring_deque_t<entry_t, entry_allocator> entries;   ///< values in 'Compare' descending order, keys ascending
+  size_t pushed;                                    ///< number of pushed values, the next sequence key
+  [[no_unique_address]] Compare compare;            ///< ordering of values
+
+  /**
+   * @brief Drop values dominated by the new one and append it
+   * @param[in] key key of the value
+   * @param[in] value value to add
+   */
+  template <typename U>
+  void Append(Key const& key, U&& value) {
+    while (!entries.IsEmpty() && !compare(value, entries.Back().value))
+      entries.PopBack();
+    entries.EmplaceBack(entry_t{ key, std::forward<U>(value) });
+    ++pushed;
+  }
+
+  /**
+   * @brief Find the last occurrence of the greatest value of range
+   * @param[in] first begin of the range
+   * @param[in] last end of the range
+   * @return iterator to the value ('last' if the range is empty)
+   */
+  template <typename ForwardIt>
+  ForwardIt SkipDominated(ForwardIt first, ForwardIt last) const {
+    ForwardIt top = first;
+    for (; first != last; ++first)
+      if (!compare(*first, *top))
+        top = first;
+    return top;
+  }
+
+public:
+  /**
+   * @brief Constructor of empty deque
+   * @param[in] compare ordering of values
+   * @param[in] alloc allocator to use in deque
+   */
+  monotonic_deque_t(Compare const& compare = Compare(), Allocator const& alloc = Allocator())
+    : entries(entry_allocator(alloc)), pushed(0), compare(compare) {};
+
+  /**
+   * @brief Check is deque empty method
+   * @return true if there are no values in the window, false otherwise
+   */
+  bool IsEmpty() const {
+    return entries.IsEmpty();
+  }
+
+  /**
+   * @brief Get deque size method
+   * @return number of kept values (not more than the number of values in the window)
+   */
+  size_t Size() const {
+    return entries.Size();
+  }
+
+  /**
+   * @brief Get the greatest value of the window
+   * @return const reference to the value
+   * @warning deque must not be empty
+   */
+  T const& Top() const {
+    return entries.Front().value;
+  }
+
+  /**
+   * @brief Get key of the greatest value of the window
+   * @return const reference to the key
+   * @warning deque must not be empty
+   */
+  Key const& TopKey() const {
+    return entries.Front().key;
+  }
+
+  /**
+   * @brief Put value with given key to the window
+   * @param[in] key key of the value (not less than keys of the previous values)
+   * @param[in] value value to add
+   */
+  void Push(Key const& key, T const& value) {
+    Append(key, value);
+  }
+
+  /**
+   * @brief Put value with given key to the window
+   * @param[in] key key of the value (not less than keys of the previous values)
+   * @param[in] value value to move
+   */
+  void Push(Key const& key, T&& value) {
+    Append(key, std::move(value));
+  }
+
+  /**
+   * @brief Put value to the window keyed by its sequence number
+   * @param[in] value value to add
+   * @return key of the value (number of values pushed before it)
+   * @warning must not be mixed with pushes with explicit keys
+   */
+  Key Push(T const& value) {
+    Key key = Key(pushed);
+    Append(key, value);
+    return key;
+  }
+
+  /**
+   * @brief Put values of range to the window keyed by their sequence numbers
+   *
+   * Values before the last occurrence of the greatest value of the burst would be
+   * dropped by it anyway, so they are only numbered and never reach the storage.
+   *
+   * @param[in] first begin of the range
+   * @param[in] last end of the range
+   * @warning must not be mixed with pushes with explicit keys
+   */
+  template <typename ForwardIt>
+  void PushBatch(ForwardIt first, ForwardIt last) {
+    ForwardIt top = SkipDominated(first, last);
+    pushed += (size_t)std::distance(first, top);
+    for (; top != last; ++top)
+      Append(Key(pushed), *top);
+  }
+
+  /**
+   * @brief Put values of range to the window with given keys
+   *
+   * Values before the last occurrence of the greatest value of the burst are skipped
+   * as in PushBatch(first, last).
+   *
+   * @param[in] keys begin of the range of keys (non-decreasing)
+   * @param[in] first begin of the range of values
+   * @param[in] count number of values
+   */
+  template <typename KeyIt, typename ValueIt>
+  void PushBatch(KeyIt keys, ValueIt first, size_t count) {
+    ValueIt last = std::next(first, count);
+    ValueIt top = SkipDominated(first, last);
+    std::advance(keys, std::distance(first, top));
+    pushed += (size_t)std::distance(first, top);
+    for (; top != last; ++top, ++keys)
+      Append(*keys, *top);
+  }
+
+  /**
+   * @brief Remove values older than given key from the window
+   * @param[in] key the oldest key to keep
+   */
+  void Evict(Key const& key) {
+    while (!entries.IsEmpty() && entries.Front().key < key)
+      entries.PopFront();
+  }
+
+  /**
+   * @brief Clear deque
+   *
+   * The sequence numbering starts over.
+   */
+  void Clear() {
+    entries.Clear();
+    pushed = 0;
+  }
+};
@@ -0,0 +1,877 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Round number up to power of two
+ * @param[in] n number to round
+ * @return the smallest power of two not less than n
+ */
+constexpr size_t RoundUpToPowerOfTwo(size_t n) {
+  size_t result = 1;
+  while (result < n)
+    result *= 2;
+  return result;
+}
+
+/**
+ * @brief Inline storage of ring deque
+ *
+ * Raw memory for elements kept inside the deque object.
+ *
+ * @tparam T type of stored elements
+ * @tparam Capacity number of elements (power of two, 0 for no storage)
+ */
+template <typename T, size_t Capacity>
+class ring_inline_storage_t {
+protected:
+  /**
+   * @brief Get inline buffer
+   * @return pointer to the first slot
+   */
+  T* InlineBuffer() noexcept {
+    return reinterpret_cast<T*>(storage);
+  }
+
+private:
+  alignas(T) unsigned char storage[Capacity * sizeof(T)];   ///< memory for the elements
+};
+
+template <typename T>
+class ring_inline_storage_t<T, 0> {
+protected:
+  /**
+   * @brief Get inline buffer
+   * @return nullptr, there is no inline storage
+   */
+  T* InlineBuffer() noexcept {
+    return nullptr;
+  }
+};
+
+/**
+ * @brief Ring buffer deque class
+ *
+ * Elements are stored in one contiguous circular buffer with power-of-two capacity,
+ * so position wrap is a single mask. The buffer grows twice when full and elements
+ * are relocated by move.
+ *
+ * With non-zero 'InlineCapacity' the first buffer lives inside the deque object, so a deque
+ * that never holds more elements does not allocate at all (see small_deque_t). The buffer
+ * spills to the heap on overflow and returns inline on ShrinkToFit() when elements fit again.
+ *
+ * @tparam T type of stored elements
+ * @tparam Allocator the allocator to be used
+ * @tparam InlineCapacity number of elements stored in the deque object itself (rounded up to power of two, 0 for none)
+ */
+template <typename T, typename Allocator = std::allocator<T>, size_t InlineCapacity = 0>
+class ring_deque_t : private ring_inline_storage_t<T, InlineCapacity == 0 ? 0 : RoundUpToPowerOfTwo(InlineCapacity)> {
+private:
+  using alloc_traits = std::allocator_traits<Allocator>;  //allocator traits
+
+  static constexpr size_t initialCapacity = 16;   ///< capacity allocated on first push from empty heap buffer
+  static constexpr size_t inlineCapacity = InlineCapacity == 0 ? 0 : RoundUpToPowerOfTwo(InlineCapacity);   ///< capacity of inline buffer
+  static constexpr bool nothrowMove = inlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value;   ///< true if moving deque cannot throw
+
+  T* buffer;                  ///< circular buffer (inline buffer or nullptr if nothing was allocated)
+  size_t capacity;            ///< number of elements in the buffer (zero or power of two)
+  size_t head;                ///< position of the first element in the buffer
+  size_t size;                ///< size in elements in the deque
+
+  Allocator alloc;            ///< the allocator for the buffer
+
+  /**
+   * @brief Ring deque iterator class
+   * @tparam IsConst const's of this iterator
+   */
+  template <bool IsConst>
+  class common_iterator {
+    friend class ring_deque_t;
+    template <bool> friend class common_iterator;
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, T const*, T*>;
+    using reference = std::conditional_t<IsConst, T const&, T&>;
+
+  private:
+    T* buffer;                ///< circular buffer of the deque
+    size_t mask;              ///< mask of position in the buffer
+    size_t pos;               ///< unwrapped position of the element
+
+    /**
+     * @brief Constructor from buffer and position
+     * @param[in] buffer circular buffer of the deque
+     * @param[in] mask mask of position in the buffer
+     * @param[in] pos unwrapped position of the element
+     */
+    common_iterator(T* buffer, size_t mask, size_t pos) : buffer(buffer), mask(mask), pos(pos) {};
+
+  public:
+    /**
+     * @brief Default constructor
+     */
+    common_iterator() : buffer(nullptr), mask(0), pos(0) {};
+
+    /**
+     * @brief Conversion from non-const iterator
+     * @param[in] other iterator to convert
+     */
+    template <bool WasConst, typename = std::enable_if_t<IsConst && !WasConst>>
+    common_iterator(common_iterator<WasConst> const& other) : buffer(other.buffer), mask(other.mask), pos(other.pos) {};
+
+    /**
+     * @brief Dereference operator *
+     * @return reference (const reference for const iterator) to the pointed-to element
+     */
+    reference operator*() const {
+      return buffer[pos & mask];
+    }
+
+    /**
+     * @brief Dereference operator ->
+     * @return pointer (const pointer for const iterator) to the pointed-to element
+     */
+    pointer operator->() const {
+      return buffer + (pos & mask);
+    }
+
+    /**
+     * @brief Prefix increment
+     * @return reference to this iterator
+     */
+    common_iterator& operator++() {
+      ++pos;
+      return *this;
+    }
+
+    /**
+     * @brief Postfix increment
+     * @return previous value of this iterator
+     */
+    common_iterator operator++(int) {
+      common_iterator tmp = *this;
+      ++pos;
+      return tmp;
+    }
+
+    /**
+     * @brief Prefix decrement
+     * @return reference to this iterator
+     */
+    common_iterator& operator--() {
+      --pos;
+      return *this;
+    }
+
+    /**
+     * @brief Postfix decrement
+     * @return previous value of this iterator
+     */
+    common_iterator operator--(int) {
+      common_iterator tmp = *this;
+      --pos;
+      return tmp;
+    }
+
+    /**
+     * @brief Equality operator
+     * @param[in] other iterator to compare
+     * @return true if iterators point to the same element else false
+     */
+    bool operator==(common_iterator const& other) const {
+      return pos == other.pos;
+    }
+
+    /**
+     * @brief Inequality operator
+     * @param[in] other iterator to compare
+     * @return true if iterators point to the different elements else false
+     */
+    bool operator!=(common_iterator const& other) const {
+      return pos != other.pos;
+    }
+
+    /**
+     * @brief Move iterator forward
+     * @param[in] n number of elements (may be negative)
+     * @return reference to this iterator
+     */
+    common_iterator& operator+=(difference_type n) {
+      pos += n;
+      return *this;
+    }
+
+    /**
+     * @brief Difference operator
+     * @param[in] other iterator to subtract
+     * @return number of elements between the iterators
+     */
+    difference_type operator-(common_iterator const& other) const {
+      return (difference_type)(pos - other.pos);
+    }
+
+    /**
+     * @brief Less operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator points before the other one
+     */
+    bool operator<(common_iterator const& other) const {
+      return (difference_type)(pos - other.pos) < 0;
+    }
+
+    /**
+     * @brief Subscript operator
+     * @param[in] n offset from this iterator
+     * @return reference (const reference for const iterator) to the element at the offset
+     */
+    reference operator[](difference_type n) const {
+      return *(*this + n);
+    }
+
+    /**
+     * @brief Move iterator backward
+     * @param[in] n number of elements
+     * @return reference to this iterator
+     */
+    common_iterator& operator-=(difference_type n) {
+      return *this += -n;
+    }
+
+    /**
+     * @brief Get iterator moved forward
+     * @param[in] n number of elements
+     * @return moved iterator
+     */
+    common_iterator operator+(difference_type n) const {
+      common_iterator tmp = *this;
+      return tmp += n;
+    }
+
+    /**
+     * @brief Get iterator moved forward
+     * @param[in] n number of elements
+     * @param[in] it iterator to move
+     * @return moved iterator
+     */
+    friend common_iterator operator+(difference_type n, common_iterator const& it) {
+      return it + n;
+    }
+
+    /**
+     * @brief Get iterator moved backward
+     * @param[in] n number of elements
+     * @return moved iterator
+     */
+    common_iterator operator-(difference_type n) const {
+      common_iterator tmp = *this;
+      return tmp += -n;
+    }
+
+    /**
+     * @brief Greater operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator points after the other one
+     */
+    bool operator>(common_iterator const& other) const {
+      return other < *this;
+    }
+
+    /**
+     * @brief Less or equal operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator does not point after the other one
+     */
+    bool operator<=(common_iterator const& other) const {
+      return !(other < *this);
+    }
+
+    /**
+     * @brief Greater or equal operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator does not point before the other one
+     */
+    bool operator>=(common_iterator const& other) const {
+      return !(*this < other);
+    }
+  };
+
+  /**
+   * @brief Check whether elements are in the inline buffer
+   * @return true if no heap buffer is used
+   */
+  bool IsInline() {
+    return buffer == this->InlineBuffer();
+  }
+
+  /**
+   * @brief Move elements to a new buffer of given capacity
+   * @param[in] newCapacity capacity of the new buffer (power of two, not less than size; inline capacity to use inline buffer)
+   */
+  void Relocate(size_t newCapacity) {
+    T* newBuffer = newCapacity == inlineCapacity ? this->InlineBuffer() : alloc_traits::allocate(alloc, newCapacity);
+    size_t moved = 0;
+
+    try {
+      for (; moved < size; ++moved)
+        alloc_traits::construct(alloc, newBuffer + moved, std::move_if_noexcept(buffer[(head + moved) & (capacity - 1)]));
+    }
+    catch (...) {
+      for (size_t i = 0; i < moved; ++i)
+        alloc_traits::destroy(alloc, newBuffer + i);
+      if (newBuffer != this->InlineBuffer())
+        alloc_traits::deallocate(alloc, newBuffer, newCapacity);
+      throw;
+    }
+
+    for (size_t i = 0; i < size; ++i)
+      alloc_traits::destroy(alloc, buffer + ((head + i) & (capacity - 1)));
+    if (!IsInline())
+      alloc_traits::deallocate(alloc, buffer, capacity);
+
+    buffer = newBuffer;
+    capacity = newCapacity;
+    head = 0;
+  }
+
+  /**
+   * @brief Grow full deque and construct element in place at given end
+   *
+   * The element is constructed in the new buffer before the old elements are moved,
+   * so the arguments may refer to elements of the deque (e.g. PushBack(Front())).
+   *
+   * @param[in] atBack true to add the element to the end, false to add it to the begin
+   * @param[in] args arguments for the element constructor
+   */
+  template <typename... Args>
+  void GrowEmplace(bool atBack, Args&&... args) {
+    // the grown buffer is never the inline one: it is larger than inline capacity
+    size_t newCapacity = capacity == 0 ? initialCapacity : capacity * 2;
+    T* newBuffer = alloc_traits::allocate(alloc, newCapacity);
+    size_t slot = atBack ? size : newCapacity - 1;
+
+    try {
+      alloc_traits::construct(alloc, newBuffer + slot, std::forward<Args>(args)...);
+    }
+    catch (...) {
+      alloc_traits::deallocate(alloc, newBuffer, newCapacity);
+      throw;
+    }
+
+    size_t moved = 0;
+    try {
+      for (; moved < size; ++moved)
+        alloc_traits::construct(alloc, newBuffer + moved, std::move_if_noexcept(buffer[(head + moved) & (capacity - 1)]));
+    }
+    catch (...) {
+      for (size_t i = 0; i < moved; ++i)
+        alloc_traits::destroy(alloc, newBuffer + i);
+      alloc_traits::destroy(alloc, newBuffer + slot);
+      alloc_traits::deallocate(alloc, newBuffer, newCapacity);
+      throw;
+    }
+
+    for (size_t i = 0; i < size; ++i)
+      alloc_traits::destroy(alloc, buffer + ((head + i) & (capacity - 1)));
+    if (!IsInline())
+      alloc_traits::deallocate(alloc, buffer, capacity);
+
+    buffer = newBuffer;
+    capacity = newCapacity;
+    head = atBack ? 0 : newCapacity - 1;
+    ++size;
+  }
+
+  /**
+   * @brief Take elements of other deque, leaving it empty
+   *
+   * Heap buffer is taken as is, elements of inline buffer are moved one by one.
+   *
+   * @param[in] other deque to take elements from (this deque must be empty and inline)
+   */
+  void TakeElements(ring_deque_t& other) {
+    if (!other.IsInline()) {
+      buffer = other.buffer;
+      capacity = other.capacity;
+      head = other.head;
+      size = other.size;
+      other.buffer = other.InlineBuffer();
+      other.capacity = inlineCapacity;
+      other.head = 0;
+      other.size = 0;
+      return;
+    }
+
+    try {
+      for (; size < other.size; ++size)
+        alloc_traits::construct(alloc, buffer + size, std::move(other[size]));
+    }
+    catch (...) {
+      Clear();
+      throw;
+    }
+    other.Clear();
+  }
+
+public:
+  /**
+   * @brief Constructor of empty deque
+   * @param[in] alloc allocator to use in deque
+   */
+  ring_deque_t(Allocator const& alloc = Allocator())
+    : buffer(this->InlineBuffer()), capacity(inlineCapacity), head(0), size(0), alloc(alloc) {};
+
+  /**
+   * @brief Copy constructor
+   *
+   * The buffer is reserved at once; trivially copyable elements are copied with
+   * one memcpy per contiguous part.
+   *
+   * @param[in] other deque to copy
+   */
+  ring_deque_t(ring_deque_t const& other)
+    : ring_deque_t(alloc_traits::select_on_container_copy_construction(other.alloc)) {
+    Reserve(other.size);
+    if constexpr (std::is_trivially_copyable<T>::value)
+      other.ForEachSegment([&](std::span<T const> segment) {
+        std::memcpy(static_cast<void*>(buffer + size), segment.data(), segment.size() * sizeof(T));
+        size += segment.size();
+      });
+    else
+      for (auto const& value : other)
+        PushBack(value);
+  }
+
+  /**
+   * @brief Move constructor
+   * @param[in] other deque to move
+   */
+  ring_deque_t(ring_deque_t&& other) noexcept(nothrowMove)
+    : buffer(this->InlineBuffer()), capacity(inlineCapacity), head(0), size(0), alloc(std::move(other.alloc)) {
+    TakeElements(other);
+  }
+
+  /**
+   * @brief Copy assigment operator
+   * @param[in] other deque to copy
+   * @return reference to this deque
+   */
+  ring_deque_t& operator=(ring_deque_t const& other) {
+    if (this != &other) {
+      ring_deque_t copy(other);
+      Swap(copy);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Move assigment operator
+   * @param[in] other deque to move
+   * @return reference to this deque
+   */
+  ring_deque_t& operator=(ring_deque_t&& other) noexcept(nothrowMove) {
+    if (this != &other) {
+      ring_deque_t moved(std::move(other));
+      Swap(moved);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Swap contents with other deque
+   *
+   * Heap buffers are swapped in O(1), elements of inline buffers are moved.
+   *
+   * @param[in] other deque to swap with
+   */
+  void Swap(ring_deque_t& other) noexcept(nothrowMove) {
+    if (inlineCapacity == 0 || (!IsInline() && !other.IsInline())) {
+      std::swap(buffer, other.buffer);
+      std::swap(capacity, other.capacity);
+      std::swap(head, other.head);
+      std::swap(size, other.size);
+      std::swap(alloc, other.alloc);
+      return;
+    }
+
+    // allocators follow heap buffers
+    std::swap(alloc, other.alloc);
+    ring_deque_t moved(std::move(other));
+    other.TakeElements(*this);
+    TakeElements(moved);
+  }
+
+  /**
+   * @brief Check is deque empty method
+   * @return true if deque is empty, false otherwise
+   */
+  bool IsEmpty() const {
+    return size == 0;
+  }
+
+  /**
+   * @brief Get deque size method
+   * @return number of elements in the deque
+   */
+  size_t Size() const {
+    return size;
+  }
+
+  /**
+   * @brief Get deque capacity method
+   * @return number of elements the deque can hold without reallocation
+   */
+  size_t Capacity() const {
+    return capacity;
+  }
+
+  /**
+   * @brief Preallocate buffer for given number of elements
+   * @param[in] n number of elements (rounded up to power of two)
+   */
+  void Reserve(size_t n) {
+    if (n > capacity)
+      Relocate(RoundUpToPowerOfTwo(n));
+  }
+
+  /**
+   * @brief Subscript operator
+   * @param[in] i index of the element
+   * @return reference to the element
+   * @warning index is not checked
+   */
+  T& operator[](size_t i) {
+    return buffer[(head + i) & (capacity - 1)];
+  }
+
+  /**
+   * @brief Subscript operator
+   * @param[in] i index of the element
+   * @return const reference to the element
+   * @warning index is not checked
+   */
+  T const& operator[](size_t i) const {
+    return buffer[(head + i) & (capacity - 1)];
+  }
+
+  /**
+   * @brief Get element with bounds checking
+   * @param[in] i index of the element
+   * @return reference to the element
+   * @throw std::out_of_range if index is not less than size
+   */
+  T& At(size_t i) {
+    if (i >= size)
+      throw std::out_of_range("deque index out of range");
+    return (*this)[i];
+  }
+
+  /**
+   * @brief Get element with bounds checking
+   * @param[in] i index of the element
+   * @return const reference to the element
+   * @throw std::out_of_range if index is not less than size
+   */
+  T const& At(size_t i) const {
+    if (i >= size)
+      throw std::out_of_range("deque index out of range");
+    return (*this)[i];
+  }
+
+  /**
+   * @brief Get the first element
+   * @return reference to the first element
+   * @warning deque must not be empty
+   */
+  T& Front() {
+    return (*this)[0];
+  }
+
+  /**
+   * @brief Get the first element
+   * @return const reference to the first element
+   * @warning deque must not be empty
+   */
+  T const& Front() const {
+    return (*this)[0];
+  }
+
+  /**
+   * @brief Get the last element
+   * @return reference to the last element
+   * @warning deque must not be empty
+   */
+  T& Back() {
+    return (*this)[size - 1];
+  }
+
+  /**
+   * @brief Get the last element
+   * @return const reference to the last element
+   * @warning deque must not be empty
+   */
+  T const& Back() const {
+    return (*this)[size - 1];
+  }
+
+  /**
+   * @brief Construct element in place at the end of deque
+   * @param[in] args arguments for the element constructor
+   */
+  template <typename... Args>
+  void EmplaceBack(Args&&... args) {
+    if (size == capacity) {
+      GrowEmplace(true, std::forward<Args>(args)...);
+      return;
+    }
+
+    alloc_traits::construct(alloc, buffer + ((head + size) & (capacity - 1)), std::forward<Args>(args)...);
+    ++size;
+  }
+
+  /**
+   * @brief Construct element in place at the begin of deque
+   * @param[in] args arguments for the element constructor
+   */
+  template <typename... Args>
+  void EmplaceFront(Args&&... args) {
+    if (size == capacity) {
+      GrowEmplace(false, std::forward<Args>(args)...);
+      return;
+    }
+
+    size_t newHead = (head - 1) & (capacity - 1);
+    alloc_traits::construct(alloc, buffer + newHead, std::forward<Args>(args)...);
+    head = newHead;
+    ++size;
+  }
+
+  /**
+   * @brief Method put element to end of deque
+   * @param[in] value element to add
+   */
+  void PushBack(T const& value) {
+    EmplaceBack(value);
+  }
+
+  /**
+   * @brief Method put element to end of deque
+   * @param[in] value element to move
+   */
+  void PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+  }
+
+  /**
+   * @brief Method put element to begin of deque
+   * @param[in] value element to add
+   */
+  void PushFront(T const& value) {
+    EmplaceFront(value);
+  }
+
+  /**
+   * @brief Method put element to begin of deque
+   * @param[in] value element to move
+   */
+  void PushFront(T&& value) {
+    EmplaceFront(std::move(value));
+  }
+
+  /**
+   * @brief Remove element from the back of deque
+   */
+  void PopBack() {
+    if (size == 0)
+      return;
+
+    --size;
+    alloc_traits::destroy(alloc, buffer + ((head + size) & (capacity - 1)));
+  }
+
+  /**
+   * @brief Remove element from the front of deque
+   */
+  void PopFront() {
+    if (size == 0)
+      return;
+
+    alloc_traits::destroy(alloc, buffer + head);
+    head = (head + 1) & (capacity - 1);
+    --size;
+  }
+
+  using iterator = common_iterator<false>;
+  using const_iterator = common_iterator<true>;
+
+  /*
+   * @brief Begin of deque
+   * @return iterator pointed to the first element of deque
+   */
+  iterator begin() {
+    return iterator(buffer, capacity - 1, head);
+  }
+
+  /*
+   * @brief End of deque
+   * @return iterator pointed to the next after last element of deque
+   */
+  iterator end() {
+    return iterator(buffer, capacity - 1, head + size);
+  }
+
+  /*
+   * @brief Begin of deque
+   * @return const iterator pointed to the first element of deque
+   */
+  const_iterator begin() const {
+    return cbegin();
+  }
+
+  /*
+   * @brief End of deque
+   * @return const iterator pointed to the next after last element of deque
+   */
+  const_iterator end() const {
+    return cend();
+  }
+
+  std::reverse_iterator<iterator> rbegin() {
+    return std::reverse_iterator<iterator>(end());
+  }
+
+  std::reverse_iterator<iterator> rend() {
+    return std::reverse_iterator<iterator>(begin());
+  }
+
+  /*
+   * @brief Begin of deque
+   * @return const iterator pointed to the first element of deque
+   */
+  const_iterator cbegin() const noexcept {
+    return const_iterator(buffer, capacity - 1, head);
+  }
+
+  /*
+   * @brief End of deque
+   * @return const iterator pointed to the next after last element of deque
+   * @warning dereferencing can cause undefined behaviour
+   */
+  const_iterator cend() const noexcept {
+    return const_iterator(buffer, capacity - 1, head + size);
+  }
+
+  /**
+   * @brief Call function for every contiguous part of deque
+   *
+   * There are at most two parts: from the first element to the end of the buffer
+   * and the wrapped rest from the beginning of the buffer.
+   *
+   * @param[in] fn function called with std::span<T> of each part
+   */
+  template <typename Fn>
+  void ForEachSegment(Fn&& fn) {
+    ForEachSegment(0, size, fn);
+  }
+
+  /**
+   * @brief Call function for every contiguous part of deque
+   * @param[in] fn function called with std::span<T const> of each part
+   */
+  template <typename Fn>
+  void ForEachSegment(Fn&& fn) const {
+    ForEachSegment(0, size, fn);
+  }
+
+  /**
+   * @brief Call function for every contiguous part of range of elements
+   * @param[in] pos index of the first element of the range
+   * @param[in] count number of elements in the range
+   * @param[in] fn function called with std::span<T> of each part
+   * @warning the range is not checked
+   */
+  template <typename Fn>
+  void ForEachSegment(size_t pos, size_t count, Fn&& fn) {
+    if (count == 0)
+      return;
+
+    size_t first = (head + pos) & (capacity - 1);
+    size_t part = capacity - first < count ? capacity - first : count;
+    fn(std::span<T>(buffer + first, part));
+    if (part < count)
+      fn(std::span<T>(buffer, count - part));
+  }
+
+  /**
+   * @brief Call function for every contiguous part of range of elements
+   * @param[in] pos index of the first element of the range
+   * @param[in] count number of elements in the range
+   * @param[in] fn function called with std::span<T const> of each part
+   * @warning the range is not checked
+   */
+  template <typename Fn>
+  void ForEachSegment(size_t pos, size_t count, Fn&& fn) const {
+    if (count == 0)
+      return;
+
+    size_t first = (head + pos) & (capacity - 1);
+    size_t part = capacity - first < count ? capacity - first : count;
+    fn(std::span<T const>(buffer + first, part));
+    if (part < count)
+      fn(std::span<T const>(buffer, count - part));
+  }
+
+  /**
+   * @brief Clear deque
+   *
+   * The buffer is kept, so the deque can be refilled without reallocating it.
+   */
+  void Clear() {
+    if (!std::is_trivially_destructible<T>::value)
+      for (size_t i = 0; i < size; ++i)
+        alloc_traits::destroy(alloc, buffer + ((head + i) & (capacity - 1)));
+    head = 0;
+    size = 0;
+  }
+
+  /**
+   * @brief Reallocate buffer to the smallest capacity holding all elements
+   *
+   * Elements return to the inline buffer if they fit into it.
+   */
+  void ShrinkToFit() {
+    size_t fit = size <= inlineCapacity ? inlineCapacity : RoundUpToPowerOfTwo(size);
+    if (fit < capacity)
+      Relocate(fit);
+  }
+
+  /**
+   * @brief Deque destructor
+   */
+  ~ring_deque_t() {
+    Clear();
+    ShrinkToFit();
+  }
+};
+
+/**
+ * @brief Deque with inline storage for small number of elements
+ *
+ * Holds up to N elements (rounded up to power of two) inside the object itself and
+ * spills to a heap ring buffer only when more elements are pushed.
+ *
+ * @tparam T type of stored elements
+ * @tparam N number of elements stored inline
+ * @tparam Allocator the allocator to be used on overflow
+ */
+template <typename T, size_t N, typename Allocator = std::allocator<T>>
+using small_deque_t = ring_deque_t<T, Allocator, N>;
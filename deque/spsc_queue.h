@@ -0,0 +1,230 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Single-producer/single-consumer queue class
+ *
+ * Bounded ring buffer for one thread pushing at the back and one thread popping at the front.
+ * The indices owned by each side live on separate cache lines, every side also keeps a
+ * cached copy of the other side's index, so the shared line is read only when the cached
+ * value says the queue looks full (or empty). Synchronization is acquire/release only.
+ *
+ * @tparam T type of stored elements
+ * @tparam Allocator the allocator to be used
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class spsc_queue_t {
+private:
+  using alloc_traits = std::allocator_traits<Allocator>;  //allocator traits
+
+  static constexpr size_t cacheLine = 64;      ///< assumed size of cache line in bytes
+
+  alignas(cacheLine) std::atomic<size_t> tail;  ///< position after the last element, written by the producer
+  size_t cachedHead;                            ///< producer's copy of 'head'
+  alignas(cacheLine) std::atomic<size_t> head;  ///< position of the first element, written by the consumer
+  size_t cachedTail;                            ///< consumer's copy of 'tail'
+  alignas(cacheLine) T* buffer;                 ///< ring buffer
+  size_t mask;                                  ///< capacity minus one (capacity is power of two)
+  Allocator alloc;                              ///< the allocator for the buffer
+
+  /**
+   * @brief Get free slots for producer
+   * @param[in] t current tail
+   * @param[in] wanted number of slots needed
+   * @return number of free slots (refreshes cached head only if less than wanted are known)
+   */
+  size_t FreeSlots(size_t t, size_t wanted) {
+    size_t capacity = mask + 1;
+    if (capacity - (t - cachedHead) < wanted)
+      cachedHead = head.load(std::memory_order_acquire);
+    return capacity - (t - cachedHead);
+  }
+
+  /**
+   * @brief Get filled slots for consumer
+   * @param[in] h current head
+   * @param[in] wanted number of elements needed
+   * @return number of elements (refreshes cached tail only if less than wanted are known)
+   */
+  size_t FilledSlots(size_t h, size_t wanted) {
+    if (cachedTail - h < wanted)
+      cachedTail = tail.load(std::memory_order_acquire);
+    return cachedTail - h;
+  }
+
+public:
+  /**
+   * @brief Constructor of empty queue
+   * @param[in] capacity maximum number of elements (rounded up to power of two)
+   * @param[in] alloc allocator to use in queue
+   */
+  spsc_queue_t(size_t capacity, Allocator const& alloc = Allocator())
+    : tail(0), cachedHead(0), head(0), cachedTail(0), alloc(alloc) {
+    size_t rounded = 1;
+    while (rounded < capacity)
+      rounded *= 2;
+    buffer = alloc_traits::allocate(this->alloc, rounded);
+    mask = rounded - 1;
+  }
+
+  spsc_queue_t(spsc_queue_t const&) = delete;
+  spsc_queue_t& operator=(spsc_queue_t const&) = delete;
+
+  /**
+   * @brief Get queue capacity method
+   * @return maximum number of elements
+   */
+  size_t Capacity() const {
+    return mask + 1;
+  }
+
+  /**
+   * @brief Get queue size method
+   * @return number of elements at the moment of the check
+   */
+  size_t Size() const {
+    size_t h = head.load(std::memory_order_acquire);
+    return tail.load(std::memory_order_acquire) - h;
+  }
+
+  /**
+   * @brief Check is queue empty method
+   * @return true if queue was empty at the moment of the check, false otherwise
+   */
+  bool IsEmpty() const {
+    return Size() == 0;
+  }
+
+  /**
+   * @brief Construct element in place at the end of queue
+   * @param[in] args arguments for the element constructor
+   * @return false if the queue is full, true otherwise
+   * @warning may be called by the producer thread only
+   */
+  template <typename... Args>
+  bool TryEmplaceBack(Args&&... args) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (FreeSlots(t, 1) == 0)
+      return false;
+
+    alloc_traits::construct(alloc, buffer + (t & mask), std::forward<Args>(args)...);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Put element to end of queue
+   * @param[in] value element to add
+   * @return false if the queue is full, true otherwise
+   * @warning may be called by the producer thread only
+   */
+  bool TryPushBack(T const& value) {
+    return TryEmplaceBack(value);
+  }
+
+  /**
+   * @brief Put element to end of queue
+   * @param[in] value element to move
+   * @return false if the queue is full, true otherwise
+   * @warning may be called by the producer thread only
+   */
+  bool TryPushBack(T&& value) {
+    return TryEmplaceBack(std::move(value));
+  }
+
+  /**
+   * @brief Put as many elements of range as fit to end of queue
+   *
+   * The elements are published to the consumer with one release store.
+   *
+   * @param[in] first begin of the range
+   * @param[in] count number of elements in the range
+   * @return number of pushed elements
+   * @warning may be called by the producer thread only
+   */
+  template <typename InputIt>
+  size_t TryPushBackN(InputIt first, size_t count) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t free = FreeSlots(t, count);
+    size_t n = count < free ? count : free;
+
+    size_t pushed = 0;
+    try {
+      for (; pushed < n; ++pushed, ++first)
+        alloc_traits::construct(alloc, buffer + ((t + pushed) & mask), *first);
+    }
+    catch (...) {
+      tail.store(t + pushed, std::memory_order_release);
+      throw;
+    }
+    tail.store(t + n, std::memory_order_release);
+    return n;
+  }
+
+  /**
+   * @brief Remove element from the front of queue
+   * @param[out] value where to move the removed element
+   * @return false if the queue is empty, true otherwise
+   * @warning may be called by the consumer thread only
+   */
+  bool TryPopFront(T& value) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (FilledSlots(h, 1) == 0)
+      return false;
+
+    T* element = buffer + (h & mask);
+    value = std::move(*element);
+    alloc_traits::destroy(alloc, element);
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Move up to given number of elements from the front of queue to output iterator
+   *
+   * The slots are released to the producer with one release store.
+   *
+   * @param[in] out output iterator to move elements to
+   * @param[in] count maximum number of elements to pop
+   * @return number of popped elements
+   * @warning may be called by the consumer thread only
+   */
+  template <typename OutputIt>
+  size_t TryPopFrontN(OutputIt out, size_t count) {
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t filled = FilledSlots(h, count);
+    size_t n = count < filled ? count : filled;
+
+    size_t popped = 0;
+    try {
+      for (; popped < n; ++popped) {
+        T* element = buffer + ((h + popped) & mask);
+        *out++ = std::move(*element);
+        alloc_traits::destroy(alloc, element);
+      }
+    }
+    catch (...) {
+      head.store(h + popped, std::memory_order_release);
+      throw;
+    }
+    head.store(h + n, std::memory_order_release);
+    return n;
+  }
+
+  /**
+   * @brief Queue destructor
+   * @warning neither producer nor consumer may use the queue during destruction
+   */
+  ~spsc_queue_t() {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (!std::is_trivially_destructible<T>::value)
+      for (size_t h = head.load(std::memory_order_relaxed); h != t; ++h)
+        alloc_traits::destroy(alloc, buffer + (h & mask));
+    alloc_traits::deallocate(alloc, buffer, mask + 1);
+  }
+};
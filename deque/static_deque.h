@@ -0,0 +1,692 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Slot of static deque
+ *
+ * Union, so the element is constructed only when pushed and the storage is usable
+ * in constant evaluation.
+ *
+ * @tparam T type of stored element
+ */
+template <typename T, bool = std::is_trivially_destructible<T>::value>
+union static_deque_slot_t {
+  T value;                    ///< stored element (alive only between push and pop)
+
+  constexpr static_deque_slot_t() {};
+};
+
+template <typename T>
+union static_deque_slot_t<T, false> {
+  T value;                    ///< stored element (alive only between push and pop)
+
+  constexpr static_deque_slot_t() {};
+  constexpr ~static_deque_slot_t() {};
+};
+
+/**
+ * @brief Static deque class
+ *
+ * Fixed-capacity ring buffer stored inside the object: it never allocates, so it can be
+ * used on paths where the heap is forbidden. All operations are constexpr. Pushes to a full
+ * deque throw std::length_error, TryPush* return false instead.
+ *
+ * @tparam T type of stored elements
+ * @tparam N capacity, the maximum number of elements
+ */
+template <typename T, size_t N>
+class static_deque_t {
+  static_assert(N > 0, "static_deque_t requires non-zero capacity");
+
+private:
+  static_deque_slot_t<T> slots[N];    ///< circular buffer
+  size_t head;                        ///< position of the first element in the buffer
+  size_t size;                        ///< size in elements in the deque
+
+  /**
+   * @brief Wrap position in buffer
+   * @param[in] pos position less than two capacities
+   * @return position less than capacity
+   */
+  static constexpr size_t Wrap(size_t pos) {
+    return pos >= N ? pos - N : pos;
+  }
+
+  /**
+   * @brief Construct element in place at the end of deque
+   * @param[in] args arguments for the element constructor
+   * @warning deque must not be full
+   */
+  template <typename... Args>
+  constexpr void EmplaceBackUnchecked(Args&&... args) {
+    std::construct_at(&slots[Wrap(head + size)].value, std::forward<Args>(args)...);
+    ++size;
+  }
+
+  /**
+   * @brief Static deque iterator class
+   * @tparam IsConst const's of this iterator
+   */
+  template <bool IsConst>
+  class common_iterator {
+    friend class static_deque_t;
+    template <bool> friend class common_iterator;
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, T const*, T*>;
+    using reference = std::conditional_t<IsConst, T const&, T&>;
+
+  private:
+    using deque_pointer = std::conditional_t<IsConst, static_deque_t const*, static_deque_t*>;
+
+    deque_pointer deque;      ///< the deque
+    size_t index;             ///< index of the element in the deque
+
+    /**
+     * @brief Constructor from deque and index
+     * @param[in] deque the deque
+     * @param[in] index index of the element in the deque
+     */
+    constexpr common_iterator(deque_pointer deque, size_t index) : deque(deque), index(index) {};
+
+  public:
+    /**
+     * @brief Default constructor
+     */
+    constexpr common_iterator() : deque(nullptr), index(0) {};
+
+    /**
+     * @brief Conversion from non-const iterator
+     * @param[in] other iterator to convert
+     */
+    template <bool WasConst, typename = std::enable_if_t<IsConst && !WasConst>>
+    constexpr common_iterator(common_iterator<WasConst> const& other) : deque(other.deque), index(other.index) {};
+
+    /**
+     * @brief Dereference operator *
+     * @return reference (const reference for const iterator) to the pointed-to element
+     */
+    constexpr reference operator*() const {
+      return (*deque)[index];
+    }
+
+    /**
+     * @brief Dereference operator ->
+     * @return pointer (const pointer for const iterator) to the pointed-to element
+     */
+    constexpr pointer operator->() const {
+      return &(*deque)[index];
+    }
+
+    /**
+     * @brief Prefix increment
+     * @return reference to this iterator
+     */
+    constexpr common_iterator& operator++() {
+      ++index;
+      return *this;
+    }
+
+    /**
+     * @brief Postfix increment
+     * @return previous value of this iterator
+     */
+    constexpr common_iterator operator++(int) {
+      common_iterator tmp = *this;
+      ++index;
+      return tmp;
+    }
+
+    /**
+     * @brief Prefix decrement
+     * @return reference to this iterator
+     */
+    constexpr common_iterator& operator--() {
+      --index;
+      return *this;
+    }
+
+    /**
+     * @brief Postfix decrement
+     * @return previous value of this iterator
+     */
+    constexpr common_iterator operator--(int) {
+      common_iterator tmp = *this;
+      --index;
+      return tmp;
+    }
+
+    /**
+     * @brief Equality operator
+     * @param[in] other iterator to compare
+     * @return true if iterators point to the same element else false
+     */
+    constexpr bool operator==(common_iterator const& other) const {
+      return index == other.index;
+    }
+
+    /**
+     * @brief Inequality operator
+     * @param[in] other iterator to compare
+     * @return true if iterators point to the different elements else false
+     */
+    constexpr bool operator!=(common_iterator const& other) const {
+      return index != other.index;
+    }
+
+    /**
+     * @brief Move iterator forward
+     * @param[in] n number of elements (may be negative)
+     * @return reference to this iterator
+     */
+    constexpr common_iterator& operator+=(difference_type n) {
+      index += n;
+      return *this;
+    }
+
+    /**
+     * @brief Move iterator backward
+     * @param[in] n number of elements
+     * @return reference to this iterator
+     */
+    constexpr common_iterator& operator-=(difference_type n) {
+      index -= n;
+      return *this;
+    }
+
+    /**
+     * @brief Get iterator moved forward
+     * @param[in] n number of elements
+     * @return moved iterator
+     */
+    constexpr common_iterator operator+(difference_type n) const {
+      return common_iterator(deque, index + n);
+    }
+
+    /**
+     * @brief Get iterator moved forward
+     * @param[in] n number of elements
+     * @param[in] it iterator to move
+     * @return moved iterator
+     */
+    friend constexpr common_iterator operator+(difference_type n, common_iterator const& it) {
+      return it + n;
+    }
+
+    /**
+     * @brief Get iterator moved backward
+     * @param[in] n number of elements
+     * @return moved iterator
+     */
+    constexpr common_iterator operator-(difference_type n) const {
+      return common_iterator(deque, index - n);
+    }
+
+    /**
+     * @brief Difference operator
+     * @param[in] other iterator to subtract
+     * @return number of elements between the iterators
+     */
+    constexpr difference_type operator-(common_iterator const& other) const {
+      return (difference_type)(index - other.index);
+    }
+
+    /**
+     * @brief Subscript operator
+     * @param[in] n offset from this iterator
+     * @return reference (const reference for const iterator) to the element at the offset
+     */
+    constexpr reference operator[](difference_type n) const {
+      return (*deque)[index + n];
+    }
+
+    /**
+     * @brief Less operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator points before the other one
+     */
+    constexpr bool operator<(common_iterator const& other) const {
+      return index < other.index;
+    }
+
+    /**
+     * @brief Greater operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator points after the other one
+     */
+    constexpr bool operator>(common_iterator const& other) const {
+      return other < *this;
+    }
+
+    /**
+     * @brief Less or equal operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator does not point after the other one
+     */
+    constexpr bool operator<=(common_iterator const& other) const {
+      return !(other < *this);
+    }
+
+    /**
+     * @brief Greater or equal operator
+     * @param[in] other iterator to compare
+     * @return true if this iterator does not point before the other one
+     */
+    constexpr bool operator>=(common_iterator const& other) const {
+      return !(*this < other);
+    }
+  };
+
+public:
+  /**
+   * @brief Constructor of empty deque
+   */
+  constexpr static_deque_t() : head(0), size(0) {};
+
+  /**
+   * @brief Constructor from initializer list
+   * @param[in] values elements to put to deque
+   * @throw std::length_error if there are more values than the capacity
+   */
+  constexpr static_deque_t(std::initializer_list<T> values) : static_deque_t() {
+    for (auto const& value : values)
+      PushBack(value);
+  }
+
+  /**
+   * @brief Copy constructor
+   * @param[in] other deque to copy
+   */
+  constexpr static_deque_t(static_deque_t const& other) : static_deque_t() {
+    for (auto const& value : other)
+      EmplaceBackUnchecked(value);
+  }
+
+  /**
+   * @brief Move constructor
+   *
+   * Elements are moved one by one, the other deque keeps moved-from elements.
+   *
+   * @param[in] other deque to move
+   */
+  constexpr static_deque_t(static_deque_t&& other) noexcept(std::is_nothrow_move_constructible<T>::value) : static_deque_t() {
+    for (auto& value : other)
+      EmplaceBackUnchecked(std::move(value));
+  }
+
+  /**
+   * @brief Copy assigment operator
+   * @param[in] other deque to copy
+   * @return reference to this deque
+   */
+  constexpr static_deque_t& operator=(static_deque_t const& other) {
+    if (this != &other) {
+      Clear();
+      for (auto const& value : other)
+        EmplaceBackUnchecked(value);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Move assigment operator
+   * @param[in] other deque to move
+   * @return reference to this deque
+   */
+  constexpr static_deque_t& operator=(static_deque_t&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+    if (this != &other) {
+      Clear();
+      for (auto& value : other)
+        EmplaceBackUnchecked(std::move(value));
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Check is deque empty method
+   * @return true if deque is empty, false otherwise
+   */
+  constexpr bool IsEmpty() const {
+    return size == 0;
+  }
+
+  /**
+   * @brief Check is deque full method
+   * @return true if no more elements can be pushed, false otherwise
+   */
+  constexpr bool IsFull() const {
+    return size == N;
+  }
+
+  /**
+   * @brief Get deque size method
+   * @return number of elements in the deque
+   */
+  constexpr size_t Size() const {
+    return size;
+  }
+
+  /**
+   * @brief Get deque capacity method
+   * @return maximum number of elements
+   */
+  static constexpr size_t Capacity() {
+    return N;
+  }
+
+  /**
+   * @brief Subscript operator
+   * @param[in] i index of the element
+   * @return reference to the element
+   * @warning index is not checked
+   */
+  constexpr T& operator[](size_t i) {
+    return slots[Wrap(head + i)].value;
+  }
+
+  /**
+   * @brief Subscript operator
+   * @param[in] i index of the element
+   * @return const reference to the element
+   * @warning index is not checked
+   */
+  constexpr T const& operator[](size_t i) const {
+    return slots[Wrap(head + i)].value;
+  }
+
+  /**
+   * @brief Get element with bounds checking
+   * @param[in] i index of the element
+   * @return reference to the element
+   * @throw std::out_of_range if index is not less than size
+   */
+  constexpr T& At(size_t i) {
+    if (i >= size)
+      throw std::out_of_range("deque index out of range");
+    return (*this)[i];
+  }
+
+  /**
+   * @brief Get element with bounds checking
+   * @param[in] i index of the element
+   * @return const reference to the element
+   * @throw std::out_of_range if index is not less than size
+   */
+  constexpr T const& At(size_t i) const {
+    if (i >= size)
+      throw std::out_of_range("deque index out of range");
+    return (*this)[i];
+  }
+
+  /**
+   * @brief Get the first element
+   * @return reference to the first element
+   * @warning deque must not be empty
+   */
+  constexpr T& Front() {
+    return (*this)[0];
+  }
+
+  /**
+   * @brief Get the first element
+   * @return const reference to the first element
+   * @warning deque must not be empty
+   */
+  constexpr T const& Front() const {
+    return (*this)[0];
+  }
+
+  /**
+   * @brief Get the last element
+   * @return reference to the last element
+   * @warning deque must not be empty
+   */
+  constexpr T& Back() {
+    return (*this)[size - 1];
+  }
+
+  /**
+   * @brief Get the last element
+   * @return const reference to the last element
+   * @warning deque must not be empty
+   */
+  constexpr T const& Back() const {
+    return (*this)[size - 1];
+  }
+
+  /**
+   * @brief Construct element in place at the end of deque if there is room
+   * @param[in] args arguments for the element constructor
+   * @return false if the deque is full, true otherwise
+   */
+  template <typename... Args>
+  constexpr bool TryEmplaceBack(Args&&... args) {
+    if (size == N)
+      return false;
+
+    EmplaceBackUnchecked(std::forward<Args>(args)...);
+    return true;
+  }
+
+  /**
+   * @brief Construct element in place at the begin of deque if there is room
+   * @param[in] args arguments for the element constructor
+   * @return false if the deque is full, true otherwise
+   */
+  template <typename... Args>
+  constexpr bool TryEmplaceFront(Args&&... args) {
+    if (size == N)
+      return false;
+
+    size_t newHead = head == 0 ? N - 1 : head - 1;
+    std::construct_at(&slots[newHead].value, std::forward<Args>(args)...);
+    head = newHead;
+    ++size;
+    return true;
+  }
+
+  /**
+   * @brief Construct element in place at the end of deque
+   * @param[in] args arguments for the element constructor
+   * @throw std::length_error if the deque is full
+   */
+  template <typename... Args>
+  constexpr void EmplaceBack(Args&&... args) {
+    if (!TryEmplaceBack(std::forward<Args>(args)...))
+      throw std::length_error("static deque is full");
+  }
+
+  /**
+   * @brief Construct element in place at the begin of deque
+   * @param[in] args arguments for the element constructor
+   * @throw std::length_error if the deque is full
+   */
+  template <typename... Args>
+  constexpr void EmplaceFront(Args&&... args) {
+    if (!TryEmplaceFront(std::forward<Args>(args)...))
+      throw std::length_error("static deque is full");
+  }
+
+  /**
+   * @brief Method put element to end of deque
+   * @param[in] value element to add
+   * @throw std::length_error if the deque is full
+   */
+  constexpr void PushBack(T const& value) {
+    EmplaceBack(value);
+  }
+
+  /**
+   * @brief Method put element to end of deque
+   * @param[in] value element to move
+   * @throw std::length_error if the deque is full
+   */
+  constexpr void PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+  }
+
+  /**
+   * @brief Method put element to begin of deque
+   * @param[in] value element to add
+   * @throw std::length_error if the deque is full
+   */
+  constexpr void PushFront(T const& value) {
+    EmplaceFront(value);
+  }
+
+  /**
+   * @brief Method put element to begin of deque
+   * @param[in] value element to move
+   * @throw std::length_error if the deque is full
+   */
+  constexpr void PushFront(T&& value) {
+    EmplaceFront(std::move(value));
+  }
+
+  /**
+   * @brief Put element to end of deque if there is room
+   * @param[in] value element to add
+   * @return false if the deque is full, true otherwise
+   */
+  constexpr bool TryPushBack(T const& value) {
+    return TryEmplaceBack(value);
+  }
+
+  /**
+   * @brief Put element to end of deque if there is room
+   * @param[in] value element to move
+   * @return false if the deque is full, true otherwise
+   */
+  constexpr bool TryPushBack(T&& value) {
+    return TryEmplaceBack(std::move(value));
+  }
+
+  /**
+   * @brief Put element to begin of deque if there is room
+   * @param[in] value element to add
+   * @return false if the deque is full, true otherwise
+   */
+  constexpr bool TryPushFront(T const& value) {
+    return TryEmplaceFront(value);
+  }
+
+  /**
+   * @brief Put element to begin of deque if there is room
+   * @param[in] value element to move
+   * @return false if the deque is full, true otherwise
+   */
+  constexpr bool TryPushFront(T&& value) {
+    return TryEmplaceFront(std::move(value));
+  }
+
+  /**
+   * @brief Remove element from the back of deque
+   */
+  constexpr void PopBack() {
+    if (size == 0)
+      return;
+
+    --size;
+    std::destroy_at(&slots[Wrap(head + size)].value);
+  }
+
+  /**
+   * @brief Remove element from the front of deque
+   */
+  constexpr void PopFront() {
+    if (size == 0)
+      return;
+
+    std::destroy_at(&slots[head].value);
+    head = Wrap(head + 1);
+    --size;
+  }
+
+  using iterator = common_iterator<false>;
+  using const_iterator = common_iterator<true>;
+
+  /*
+   * @brief Begin of deque
+   * @return iterator pointed to the first element of deque
+   */
+  constexpr iterator begin() {
+    return iterator(this, 0);
+  }
+
+  /*
+   * @brief End of deque
+   * @return iterator pointed to the next after last element of deque
+   */
+  constexpr iterator end() {
+    return iterator(this, size);
+  }
+
+  /*
+   * @brief Begin of deque
+   * @return const iterator pointed to the first element of deque
+   */
+  constexpr const_iterator begin() const {
+    return cbegin();
+  }
+
+  /*
+   * @brief End of deque
+   * @return const iterator pointed to the next after last element of deque
+   */
+  constexpr const_iterator end() const {
+    return cend();
+  }
+
+  constexpr std::reverse_iterator<iterator> rbegin() {
+    return std::reverse_iterator<iterator>(end());
+  }
+
+  constexpr std::reverse_iterator<iterator> rend() {
+    return std::reverse_iterator<iterator>(begin());
+  }
+
+  /*
+   * @brief Begin of deque
+   * @return const iterator pointed to the first element of deque
+   */
+  constexpr const_iterator cbegin() const noexcept {
+    return const_iterator(this, 0);
+  }
+
+  /*
+   * @brief End of deque
+   * @return const iterator pointed to the next after last element of deque
+   * @warning dereferencing can cause undefined behaviour
+   */
+  constexpr const_iterator cend() const noexcept {
+    return const_iterator(this, size);
+  }
+
+  /**
+   * @brief Clear deque
+   */
+  constexpr void Clear() {
+    if constexpr (!std::is_trivially_destructible<T>::value)
+      for (size_t i = 0; i < size; ++i)
+        std::destroy_at(&slots[Wrap(head + i)].value);
+    head = 0;
+    size = 0;
+  }
+
+  /**
+   * @brief Deque destructor
+   */
+  constexpr ~static_deque_t() {
+    Clear();
+  }
+};
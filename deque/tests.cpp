@@ -0,0 +1,1604 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <set>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "arena_allocator.h"
+#include "async_deque.h"
+#include "block_deque.h"
+#include "blocking_deque.h"
+#include "caching_allocator.h"
+#include "concurrent_deque.h"
+#include "deque.h"
+#include "deque_policy.h"
+#include "deque_serialization.h"
+#include "deque_simd.h"
+#include "deque_stats.h"
+#include "intrusive_deque.h"
+#include "mmap_deque.h"
+#include "monotonic_deque.h"
+#include "ring_deque.h"
+#include "spsc_queue.h"
+#include "static_deque.h"
+#include "work_stealing_deque.h"
+
+/**
+ * @brief Trivially copyable element without default constructor
+ */
+struct point_t {
+  explicit point_t(int x) : x(x), y(-x) {};
+  int x;                      ///< the value
+  int y;                      ///< the negated value
+};
+
+static int failures = 0;      ///< number of failed checks
+
+/**
+ * @brief Report failed check without stopping the tests
+ */
+#define DEQUE_CHECK(condition)                                                    \
+  do {                                                                            \
+    if (!(condition)) {                                                           \
+      std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      ++failures;                                                                 \
+    }                                                                             \
+  } while (0)
+
+/**
+ * @brief Push copies of own elements while the ring grows
+ */
+template <typename Deque>
+static void TestRingPushOwnElement() {
+  Deque back, front, middle;
+  std::string first(32, 'a'), last(32, 'z');
+  back.PushBack(first);
+  front.PushFront(last);
+  middle.PushBack(first);
+  for (size_t i = 1; i < 200; ++i) {
+    back.PushBack(back.Front());
+    front.PushFront(front.Back());
+    middle.PushBack(middle[i / 2]);
+  }
+
+  DEQUE_CHECK(back.Size() == 200 && front.Size() == 200 && middle.Size() == 200);
+  for (size_t i = 0; i < 200; ++i) {
+    DEQUE_CHECK(back[i] == first);
+    DEQUE_CHECK(front[i] == last);
+    DEQUE_CHECK(middle[i] == first);
+  }
+}
+
+/**
+ * @brief Check that counters of stats policy add up to the size
+ * @param[in] deque deque to check
+ */
+template <typename Deque>
+static bool StatsAddUp(Deque const& deque) {
+  deque_stats_t stats = deque.Stats();
+  return stats.pushBack + stats.pushFront + stats.insert - stats.popBack - stats.popFront - stats.erase == deque.Size();
+}
+
+/**
+ * @brief Count middle removals and inserts in statistics
+ */
+static void TestStatsMiddleOperations() {
+  deque_t<int, std::allocator<int>, deque_stats_on> deque;
+  for (int i = 0; i < 10; ++i)
+    deque.PushBack(i);
+  deque.Erase(deque.begin());
+  auto handle = deque.Extract(deque.begin());
+  DEQUE_CHECK(deque.Size() == 8 && deque.Stats().erase == 2 && StatsAddUp(deque));
+
+  deque.Insert(deque.end(), std::move(handle));
+  deque.Insert(deque.begin(), 42);
+  auto last = deque.begin();
+  ++last;
+  ++last;
+  deque.Erase(deque.begin(), last);
+  DEQUE_CHECK(deque.Size() == 8 && StatsAddUp(deque));
+
+  auto middle = deque.begin();
+  ++middle;
+  ++middle;
+  ++middle;
+  auto tail = deque.SplitAt(middle);
+  DEQUE_CHECK(deque.Size() == 3 && tail.Size() == 5);
+  DEQUE_CHECK(StatsAddUp(deque) && StatsAddUp(tail));
+}
+
+/**
+ * @brief Read deques serialized back to back into one stream
+ */
+static void TestSerializeBackToBack() {
+  deque_t<int> first;
+  block_deque_t<int> second;
+  for (int i = 0; i < 100100; ++i)
+    first.PushBack(i);
+  for (int i = 0; i < 3000; ++i)
+    second.PushBack(-i);
+
+  std::stringstream stream;
+  deque_serialization::SerializeTo(first, deque_serialization::ostream_writer_t{ stream });
+  deque_serialization::SerializeTo(second, deque_serialization::ostream_writer_t{ stream });
+  stream << "trailer";
+
+  deque_t<int> firstLoaded;
+  block_deque_t<int> secondLoaded;
+  deque_serialization::DeserializeFrom(firstLoaded, deque_serialization::istream_reader_t{ stream });
+  deque_serialization::DeserializeFrom(secondLoaded, deque_serialization::istream_reader_t{ stream });
+  std::string trailer;
+  stream >> trailer;
+
+  DEQUE_CHECK(firstLoaded.Size() == first.Size());
+  for (auto loaded = firstLoaded.begin(), original = first.begin(); loaded != firstLoaded.end() && original != first.end(); ++loaded, ++original)
+    DEQUE_CHECK(*loaded == *original);
+  DEQUE_CHECK(secondLoaded.Size() == second.Size());
+  for (size_t i = 0; i < second.Size() && i < secondLoaded.Size(); ++i)
+    DEQUE_CHECK(secondLoaded[i] == second[i]);
+  DEQUE_CHECK(trailer == "trailer");
+}
+
+/**
+ * @brief Load elements without default constructor and reject corrupt element count
+ */
+static void TestSerializeLoader() {
+  ring_deque_t<point_t> points;
+  for (int i = 0; i < 1000; ++i)
+    points.PushBack(point_t(i));
+
+  std::stringstream stream;
+  deque_serialization::SerializeTo(points, deque_serialization::ostream_writer_t{ stream });
+  ring_deque_t<point_t> loaded;
+  deque_serialization::DeserializeFrom(loaded, deque_serialization::istream_reader_t{ stream });
+  DEQUE_CHECK(loaded.Size() == 1000);
+  for (size_t i = 0; i < loaded.Size(); ++i)
+    DEQUE_CHECK(loaded[i].x == (int)i && loaded[i].y == -(int)i);
+
+  // huge count must not be reserved up front, the data ends long before it
+  deque_serialization::header_t header = { deque_serialization::magic, deque_serialization::version, (uint32_t)sizeof(point_t), UINT64_MAX / 2 };
+  std::stringstream corrupt;
+  corrupt.write(reinterpret_cast<char const*>(&header), sizeof(header));
+  bool truncated = false;
+  try {
+    deque_serialization::DeserializeFrom(loaded, deque_serialization::istream_reader_t{ corrupt });
+  }
+  catch (std::runtime_error const&) {
+    truncated = true;
+  }
+  DEQUE_CHECK(truncated);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+/**
+ * @brief Reopen mmap deque file enlarged without updating its header
+ *
+ * Such file is left when Grow() is interrupted between ftruncate and the header update.
+ */
+static void TestMmapReopenEnlargedFile() {
+  char path[] = "/tmp/deque_tests_XXXXXX";
+  int fd = ::mkstemp(path);
+  DEQUE_CHECK(fd >= 0);
+  if (fd < 0)
+    return;
+  ::close(fd);
+  ::unlink(path);
+
+  {
+    mmap_deque_t<int> deque(path, 256);
+    for (int i = 0; i < 100; ++i)
+      deque.PushBack(i);
+    deque.Flush();
+  }
+
+  struct stat info;
+  DEQUE_CHECK(::stat(path, &info) == 0 && ::truncate(path, info.st_size * 2) == 0);
+
+  {
+    mmap_deque_t<int> deque(path, 256);
+    DEQUE_CHECK(deque.Size() == 100);
+    for (int i = 100; i < 1000; ++i)
+      deque.PushBack(i);
+    deque.Flush();
+  }
+
+  {
+    mmap_deque_t<int> deque(path, 256);
+    DEQUE_CHECK(deque.Size() == 1000);
+    for (int i = 0; i < 1000 && !deque.IsEmpty(); ++i) {
+      DEQUE_CHECK(deque.Front() == i);
+      deque.PopFront();
+    }
+  }
+
+  DEQUE_CHECK(::stat(path, &info) == 0 && ::truncate(path, info.st_size / 2) == 0);
+  bool truncated = false;
+  try {
+    mmap_deque_t<int> deque(path, 256);
+  }
+  catch (std::runtime_error const&) {
+    truncated = true;
+  }
+  DEQUE_CHECK(truncated);
+  ::unlink(path);
+}
+#endif
+
+/**
+ * @brief Reuse nodes of small lock-free deque retired below the scan threshold
+ */
+static void TestConcurrentSmallCapacity() {
+  concurrent_deque_t<int> deque(100);
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 100; ++i)
+      DEQUE_CHECK(deque.TryPushBack(i));
+    DEQUE_CHECK(!deque.TryPushBack(100));
+    int value = -1;
+    for (int i = 0; i < 100; ++i)
+      DEQUE_CHECK(deque.TryPopFront(value) && value == i);
+    DEQUE_CHECK(deque.IsEmpty());
+  }
+  DEQUE_CHECK(deque.TryPushFront(1));
+}
+
+/**
+ * @brief Push and pop at both ends from several threads, every element is popped once
+ */
+static void TestConcurrentStress() {
+  constexpr int threads = 4;
+  constexpr int perThread = 20000;
+  concurrent_deque_t<int> deque(1000);
+  std::vector<std::atomic<int>> seen(threads * perThread);
+  std::atomic<int> popped(0);
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t)
+    workers.emplace_back([&, t]() {
+      int value;
+      for (int i = 0; i < perThread; ++i) {
+        int pushed = t * perThread + i;
+        bool ok = (i & 1) ? deque.TryPushBack(pushed) : deque.TryPushFront(pushed);
+        while (!ok) {
+          // full: make room, then retry
+          if (deque.TryPopBack(value)) {
+            seen[value].fetch_add(1);
+            popped.fetch_add(1);
+          }
+          ok = deque.TryPushBack(pushed);
+        }
+        if (((i & 3) == 0 ? deque.TryPopBack(value) : deque.TryPopFront(value))) {
+          seen[value].fetch_add(1);
+          popped.fetch_add(1);
+        }
+      }
+    });
+  for (auto& worker : workers)
+    worker.join();
+
+  int value;
+  while (deque.TryPopFront(value)) {
+    seen[value].fetch_add(1);
+    popped.fetch_add(1);
+  }
+  DEQUE_CHECK(popped.load() == threads * perThread);
+  for (auto& count : seen)
+    DEQUE_CHECK(count.load() == 1);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+/**
+ * @brief Push own front element while the file grows, reject corrupt block size
+ */
+static void TestMmapPushOwnElement() {
+  char path[] = "/tmp/deque_tests_XXXXXX";
+  int fd = ::mkstemp(path);
+  DEQUE_CHECK(fd >= 0);
+  if (fd < 0)
+    return;
+  ::close(fd);
+  ::unlink(path);
+
+  {
+    mmap_deque_t<point_t> deque(path, 128);
+    deque.PushBack(point_t(7));
+    for (int i = 0; i < 5000; ++i)
+      deque.PushBack(deque.Front());
+    DEQUE_CHECK(deque.Size() == 5001);
+    for (; !deque.IsEmpty(); deque.PopFront())
+      DEQUE_CHECK(deque.Front().x == 7 && deque.Front().y == -7);
+    deque.Flush();
+  }
+
+  // blockBytes is the third field of the header
+  uint64_t blockBytes = 8;
+  fd = ::open(path, O_RDWR);
+  DEQUE_CHECK(fd >= 0 && ::pwrite(fd, &blockBytes, sizeof(blockBytes), 16) == (ssize_t)sizeof(blockBytes));
+  ::close(fd);
+  bool corrupt = false;
+  try {
+    mmap_deque_t<point_t> deque(path);
+  }
+  catch (std::runtime_error const&) {
+    corrupt = true;
+  }
+  DEQUE_CHECK(corrupt);
+  ::unlink(path);
+}
+#endif
+
+/**
+ * @brief Allocator counting live allocations and copy-construction selections
+ */
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  static inline long live = 0;        ///< number of not deallocated allocations of all types
+  static inline int selected = 0;     ///< number of select_on_container_copy_construction calls
+
+  counting_allocator() = default;
+  template <typename U>
+  counting_allocator(counting_allocator<U> const&) {};
+
+  T* allocate(size_t n) {
+    ++counting_allocator<char>::live;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, size_t n) {
+    --counting_allocator<char>::live;
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  counting_allocator select_on_container_copy_construction() const {
+    ++counting_allocator<char>::selected;
+    return *this;
+  }
+
+  template <typename U>
+  bool operator==(counting_allocator<U> const&) const { return true; }
+};
+
+/**
+ * @brief Element whose copy throws after given number of copies
+ */
+struct throwing_copy_t {
+  static inline int budget = -1;      ///< copies left before the throwing one (negative for no limit)
+
+  int value;                          ///< the value
+
+  explicit throwing_copy_t(int value) : value(value) {};
+  throwing_copy_t(throwing_copy_t const& other) : value(other.value) {
+    if (budget >= 0 && budget-- == 0)
+      throw std::runtime_error("copy failed");
+  }
+  throwing_copy_t& operator=(throwing_copy_t const&) = default;
+};
+
+/**
+ * @brief Copy deque with node pool, failing in the middle of the copy
+ */
+static void TestDequeCopyFailure() {
+  using deque_type = deque_t<throwing_copy_t, counting_allocator<throwing_copy_t>>;
+  {
+    deque_type deque;
+    deque.SetNodePoolLimit(100);
+    for (int i = 0; i < 50; ++i)
+      deque.PushBack(throwing_copy_t(i));
+    long live = counting_allocator<char>::live;
+    int selected = counting_allocator<char>::selected;
+
+    throwing_copy_t::budget = 20;
+    bool thrown = false;
+    try {
+      deque_type copy(deque);
+    }
+    catch (std::runtime_error const&) {
+      thrown = true;
+    }
+    throwing_copy_t::budget = -1;
+    DEQUE_CHECK(thrown && counting_allocator<char>::live == live);
+    DEQUE_CHECK(counting_allocator<char>::selected == selected + 1);
+
+    deque_type copy(deque);
+    DEQUE_CHECK(copy.Size() == 50 && copy.Back().value == 49);
+  }
+  DEQUE_CHECK(counting_allocator<char>::live == 0);
+}
+
+/**
+ * @brief Clear returns nodes to shared arena, ClearForArenaReset leaves them to Reset()
+ */
+static void TestArenaClear() {
+  arena_t arena;
+  deque_t<int, arena_allocator<int>> deque{ arena_allocator<int>(arena) };
+
+  std::set<int const*> first;
+  for (int i = 0; i < 1000; ++i)
+    deque.PushBack(i);
+  for (int const& value : deque)
+    first.insert(&value);
+  deque.Clear();
+
+  // the nodes went to the free lists of the arena and are reused by the next pushes
+  for (int i = 0; i < 1000; ++i)
+    deque.PushBack(i);
+  bool reused = true;
+  for (int const& value : deque)
+    reused = reused && first.count(&value) == 1;
+  DEQUE_CHECK(reused);
+
+  deque.SetNodePoolLimit(10);
+  deque.PopFront();
+  deque.ClearForArenaReset();
+  arena.Reset();
+  DEQUE_CHECK(deque.IsEmpty());
+  for (int i = 0; i < 100; ++i)
+    deque.PushFront(i);
+  DEQUE_CHECK(deque.Size() == 100 && deque.Front() == 99 && deque.Back() == 0);
+  deque.ClearForArenaReset();
+}
+
+/**
+ * @brief Polymorphic element in two intrusive deques
+ */
+struct timer_entry_t : deque_tagged_hook_t<struct by_time_tag>, deque_tagged_hook_t<struct by_owner_tag> {
+  explicit timer_entry_t(int id) : id(id) {};
+  virtual ~timer_entry_t() = default;
+  virtual int Id() const { return id; }
+  std::string name = "timer";         ///< makes the type non-trivial
+  int id;                             ///< the value
+};
+
+/**
+ * @brief Link polymorphic elements through two tagged base hooks
+ */
+static void TestIntrusiveTaggedHooks() {
+  static_assert(!std::is_standard_layout<timer_entry_t>::value, "the test needs non-standard-layout element");
+  timer_entry_t timers[4] = { timer_entry_t(0), timer_entry_t(1), timer_entry_t(2), timer_entry_t(3) };
+  {
+    intrusive_deque_t<timer_entry_t, deque_tagged_hook_t<by_time_tag>> byTime;
+    intrusive_deque_t<timer_entry_t, deque_tagged_hook_t<by_owner_tag>> byOwner;
+    for (auto& timer : timers) {
+      byTime.PushBack(timer);
+      byOwner.PushFront(timer);
+    }
+    byTime.Erase(timers[1]);
+    DEQUE_CHECK(byTime.Size() == 3 && byOwner.Size() == 4);
+
+    int expected[] = { 0, 2, 3 };
+    int i = 0;
+    for (timer_entry_t const& timer : byTime)
+      DEQUE_CHECK(i < 3 && timer.Id() == expected[i++]);
+    DEQUE_CHECK(byOwner.Front().Id() == 3 && byOwner.Back().Id() == 0);
+    DEQUE_CHECK(&*byOwner.IteratorTo(timers[2]) == &timers[2]);
+    DEQUE_CHECK(!static_cast<deque_tagged_hook_t<by_time_tag>&>(timers[1]).IsLinked());
+  }
+  for (auto& timer : timers)
+    DEQUE_CHECK(!static_cast<deque_tagged_hook_t<by_time_tag>&>(timer).IsLinked()
+      && !static_cast<deque_tagged_hook_t<by_owner_tag>&>(timer).IsLinked());
+}
+
+/**
+ * @brief Compare vector kernels with scalar loops for all lengths around the vector width
+ *
+ * Values are small integers, so floating point sums are exact in any order.
+ */
+template <typename T>
+static void TestSimdKernels() {
+  std::vector<T> values(80 + 3);
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = (T)((i * 7) % 23) - (T)11;
+
+  for (size_t offset = 0; offset < 3; ++offset)
+    for (size_t n = 0; n <= 80; ++n) {
+      std::span<T const> segment(values.data() + offset, n);
+
+      T sum = T();
+      size_t count = 0;
+      size_t find = n;
+      for (size_t i = 0; i < n; ++i) {
+        sum += segment[i];
+        count += segment[i] == (T)5;
+        if (find == n && segment[i] == (T)5)
+          find = i;
+      }
+      DEQUE_CHECK(deque_simd::SumSegment(segment) == sum);
+      DEQUE_CHECK(deque_simd::CountSegment(segment, (T)5) == count);
+      DEQUE_CHECK(deque_simd::FindSegment(segment, (T)5) == find);
+      DEQUE_CHECK(deque_simd::FindSegment(segment, (T)100) == n);
+
+      if (n > 0) {
+        T lo = segment[0], hi = segment[0];
+        deque_simd::MinMaxSegment(segment, lo, hi);
+        DEQUE_CHECK(lo == *std::min_element(segment.begin(), segment.end()));
+        DEQUE_CHECK(hi == *std::max_element(segment.begin(), segment.end()));
+      }
+    }
+}
+
+/**
+ * @brief Run algorithms over several segments of block and ring deques
+ */
+static void TestSimdDeques() {
+  block_deque_t<int32_t, std::allocator<int32_t>, 16> blocks;
+  ring_deque_t<float> ring;
+  for (int i = 0; i < 37; ++i)
+    ring.PushBack(0.0f);
+  for (int i = 0; i < 37; ++i)
+    ring.PopFront();            // the ring wraps around below
+  for (int32_t i = 0; i < 100; ++i) {
+    blocks.PushFront(i % 9);
+    ring.PushBack((float)(i % 9));
+  }
+
+  DEQUE_CHECK(deque_simd::Sum(blocks) == 396 && deque_simd::Sum(ring) == 396.0f);
+  DEQUE_CHECK(deque_simd::Count(blocks, 8) == 11 && deque_simd::Count(ring, 8.0f) == 11);
+  DEQUE_CHECK(deque_simd::MinMax(blocks) == std::make_pair(0, 8));
+  DEQUE_CHECK(deque_simd::Find(blocks, 8) - blocks.begin() == std::find(blocks.begin(), blocks.end(), 8) - blocks.begin());
+  DEQUE_CHECK(deque_simd::Find(ring, 42.0f) == ring.end());
+  deque_simd::Fill(ring, 2.0f);
+  DEQUE_CHECK(deque_simd::Sum(ring) == 200.0f);
+}
+
+/**
+ * @brief Reuse slots through thread magazines, free on other threads, run deques on both sources
+ *
+ * With -DDEQUE_ENABLE_NUMA=ON numa_chunk_source takes chunks from libnuma.
+ */
+template <typename Source>
+static void TestCachingAllocator() {
+  using heap_type = caching_heap_t<Source>;
+  caching_allocator<int64_t, Source> alloc;
+
+  // the loaded magazine is LIFO, a freed slot is the next one allocated
+  int64_t* first = alloc.allocate(1);
+  alloc.deallocate(first, 1);
+  int64_t* again = alloc.allocate(1);
+  DEQUE_CHECK(again == first);
+
+  // more than two magazines of slots go through the depot and come back
+  std::vector<int64_t*> slots;
+  for (size_t i = 0; i < 5 * heap_type::magazineSize; ++i) {
+    slots.push_back(alloc.allocate(1));
+    *slots.back() = (int64_t)i;
+  }
+  std::set<int64_t*> distinct(slots.begin(), slots.end());
+  DEQUE_CHECK(distinct.size() == slots.size());
+  for (size_t i = 0; i < slots.size(); ++i)
+    DEQUE_CHECK(*slots[i] == (int64_t)i);
+
+  // slots freed by another thread stay usable
+  std::thread([&]() {
+    for (int64_t* slot : slots)
+      alloc.deallocate(slot, 1);
+  }).join();
+  alloc.deallocate(again, 1);
+
+  DEQUE_CHECK(Source::NodeCount() >= 1 && Source::CurrentNode() < Source::NodeCount());
+
+  std::vector<std::thread> threads;
+  std::atomic<int> wrong(0);
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([&, t]() {
+      deque_t<int, caching_allocator<int, Source>> deque;
+      for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 1000; ++i)
+          deque.PushBack(t * 1000 + i);
+        for (int i = 0; i < 1000; ++i) {
+          wrong += deque.Front() != t * 1000 + i;
+          deque.PopFront();
+        }
+      }
+    });
+  for (auto& thread : threads)
+    thread.join();
+  DEQUE_CHECK(wrong.load() == 0);
+}
+
+/**
+ * @brief Coroutine started at once and destroyed when it finishes
+ */
+struct task_t {
+  struct promise_type {
+    task_t get_return_object() { return task_t(); }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+/**
+ * @brief Pop one element
+ * @param[in] deque deque to pop from
+ * @param[out] result the popped element
+ * @param[out] order number of completed pops, taken as this pop completes
+ * @param[in,out] completed counter of completed pops
+ */
+template <typename T>
+static task_t PopOne(async_deque_t<T>& deque, std::optional<T>& result, int& order, int& completed) {
+  result = co_await deque.PopFrontAsync();
+  order = completed++;
+}
+
+/**
+ * @brief Pop one batch
+ * @param[in] deque deque to pop from
+ * @param[in] max maximum number of elements
+ * @param[out] result the popped elements
+ * @param[out] done set when the pop completes
+ */
+static task_t PopBatch(async_deque_t<int>& deque, size_t max, std::vector<int>& result, bool& done) {
+  result = co_await deque.PopFrontBatchAsync(max);
+  done = true;
+}
+
+/**
+ * @brief Wake suspended pops in FIFO order by single and batch pushes, close with waiters
+ */
+static void TestAsyncWakeOrder() {
+  async_deque_t<int> deque;
+  std::optional<int> results[3];
+  int order[3] = {-1, -1, -1};
+  int completed = 0;
+  for (int i = 0; i < 3; ++i)
+    PopOne(deque, results[i], order[i], completed);
+  DEQUE_CHECK(completed == 0);
+
+  // the longest waiting pop is resumed first, on the pushing thread
+  DEQUE_CHECK(deque.PushBack(10));
+  DEQUE_CHECK(completed == 1 && order[0] == 0 && results[0] == 10);
+  int values[] = {11, 12, 13};
+  DEQUE_CHECK(deque.PushBackBatch(values, values + 3));
+  DEQUE_CHECK(completed == 3 && order[1] == 1 && order[2] == 2);
+  DEQUE_CHECK(results[1] == 11 && results[2] == 12);
+  DEQUE_CHECK(deque.Size() == 1);
+
+  // a queued element completes the pop without suspending
+  std::optional<int> last;
+  int lastOrder = -1;
+  PopOne(deque, last, lastOrder, completed);
+  DEQUE_CHECK(last == 13 && deque.IsEmpty());
+
+  // a batch pop takes up to its limit, the next waiter gets the rest
+  std::vector<int> batch;
+  bool batchDone = false;
+  PopBatch(deque, 3, batch, batchDone);
+  std::optional<int> after;
+  int afterOrder = -1;
+  PopOne(deque, after, afterOrder, completed);
+  int more[] = {20, 21, 22, 23, 24};
+  DEQUE_CHECK(deque.PushBackBatch(more, more + 5));
+  DEQUE_CHECK(batchDone && batch == std::vector<int>({20, 21, 22}));
+  DEQUE_CHECK(after == 23 && deque.Size() == 1);
+
+  // a limit of 0 is taken as 1, so a non-empty deque never yields an empty batch
+  deque.PushBack(25);
+  batchDone = false;
+  PopBatch(deque, 0, batch, batchDone);
+  DEQUE_CHECK(batchDone && batch == std::vector<int>({24}));
+  PopBatch(deque, 10, batch, batchDone);
+  DEQUE_CHECK(batch == std::vector<int>({25}));
+
+  // closing resumes waiters with nothing and rejects further pushes
+  std::optional<int> closedResult = 0;
+  int closedOrder = -1;
+  batchDone = false;
+  PopOne(deque, closedResult, closedOrder, completed);
+  PopBatch(deque, 4, batch, batchDone);
+  DEQUE_CHECK(closedOrder == -1 && !batchDone);
+  deque.Close();
+  DEQUE_CHECK(closedOrder != -1 && !closedResult.has_value());
+  DEQUE_CHECK(batchDone && batch.empty());
+  DEQUE_CHECK(!deque.PushBack(30) && deque.IsClosed());
+}
+
+/**
+ * @brief Pop thrown copies
+ * @param[in] deque deque to pop from
+ * @param[out] result value of the popped element (-1 for no element)
+ * @param[out] done set when the pop completes
+ */
+static task_t PopCopy(async_deque_t<throwing_copy_t>& deque, int& result, bool& done) {
+  std::optional<throwing_copy_t> value = co_await deque.PopFrontAsync();
+  result = value ? value->value : -1;
+  done = true;
+}
+
+/**
+ * @brief Batch push whose copy throws still resumes waiters already given an element
+ */
+static void TestAsyncBatchFailure() {
+  async_deque_t<throwing_copy_t> deque;
+  int results[2] = {0, 0};
+  bool done[2] = {false, false};
+  PopCopy(deque, results[0], done[0]);
+  PopCopy(deque, results[1], done[1]);
+
+  std::vector<throwing_copy_t> values = {throwing_copy_t(1), throwing_copy_t(2), throwing_copy_t(3)};
+  throwing_copy_t::budget = 1;
+  bool thrown = false;
+  try {
+    deque.PushBackBatch(values.begin(), values.end());
+  }
+  catch (std::runtime_error const&) {
+    thrown = true;
+  }
+  throwing_copy_t::budget = -1;
+  DEQUE_CHECK(thrown);
+  DEQUE_CHECK(done[0] && results[0] == 1);
+  DEQUE_CHECK(!done[1] && deque.IsEmpty());
+
+  deque.Close();
+  DEQUE_CHECK(done[1] && results[1] == -1);
+}
+
+/**
+ * @brief Executor running handed over coroutines on a single thread
+ */
+struct test_executor_t {
+  std::mutex mutex;                       ///< protects all members
+  std::condition_variable ready;          ///< signalled when a coroutine is handed over
+  std::vector<std::coroutine_handle<>> queue; ///< coroutines to resume
+  int handed = 0;                         ///< number of handed over coroutines
+};
+
+/**
+ * @brief Pop elements until deque is closed
+ * @param[in] deque deque to pop from
+ * @param[in] runner thread that must resume the coroutine
+ * @param[out] popped the popped elements
+ * @param[out] wrongThread set if the coroutine was resumed on another thread
+ * @param[in,out] finished counter of finished consumers
+ */
+static task_t Consume(async_deque_t<int>& deque, std::thread::id runner, std::vector<int>& popped,
+                      bool& wrongThread, std::atomic<int>& finished) {
+  for (;;) {
+    std::optional<int> value = co_await deque.PopFrontAsync();
+    wrongThread |= std::this_thread::get_id() != runner;
+    if (!value)
+      break;
+    popped.push_back(*value);
+  }
+  ++finished;
+}
+
+/**
+ * @brief One producer thread feeds consumer coroutines resumed through executor
+ */
+static void TestAsyncExecutor() {
+  test_executor_t executor;
+  async_deque_t<int> deque([&](std::coroutine_handle<> handle) {
+    std::lock_guard<std::mutex> lock(executor.mutex);
+    executor.queue.push_back(handle);
+    ++executor.handed;
+    executor.ready.notify_one();
+  });
+
+  int const consumers = 4;
+  int const count = 20000;
+  std::vector<int> popped[consumers];
+  bool wrongThread[consumers] = {};
+  std::atomic<int> finished(0);
+  for (int i = 0; i < consumers; ++i)
+    Consume(deque, std::this_thread::get_id(), popped[i], wrongThread[i], finished);
+
+  std::thread producer([&]() {
+    for (int i = 0; i < count; i += 8) {
+      if (i % 16 == 0) {
+        for (int j = i; j < i + 8; ++j)
+          deque.PushBack(j);
+      }
+      else {
+        std::vector<int> values;
+        for (int j = i; j < i + 8; ++j)
+          values.push_back(j);
+        deque.PushBackBatch(values.begin(), values.end());
+      }
+    }
+    deque.Close();
+  });
+
+  while (finished.load() != consumers) {
+    std::vector<std::coroutine_handle<>> handles;
+    {
+      std::unique_lock<std::mutex> lock(executor.mutex);
+      executor.ready.wait(lock, [&]() { return !executor.queue.empty(); });
+      handles.swap(executor.queue);
+    }
+    for (std::coroutine_handle<> handle : handles)
+      handle.resume();
+  }
+  producer.join();
+
+  std::vector<int> seen(count, 0);
+  for (int i = 0; i < consumers; ++i) {
+    DEQUE_CHECK(!wrongThread[i]);
+    for (size_t j = 0; j < popped[i].size(); ++j) {
+      ++seen[popped[i][j]];
+      // the producer pushes in order, so each consumer gets increasing values
+      DEQUE_CHECK(j == 0 || popped[i][j - 1] < popped[i][j]);
+    }
+  }
+  int wrong = 0;
+  for (int i = 0; i < count; ++i)
+    wrong += seen[i] != 1;
+  DEQUE_CHECK(wrong == 0);
+  DEQUE_CHECK(executor.handed >= consumers);
+}
+
+/**
+ * @brief Element counting its live instances
+ */
+struct tracked_t {
+  static inline long live = 0;        ///< number of constructed and not destroyed elements
+
+  int value;                          ///< the value
+
+  tracked_t(int value) : value(value) { ++live; };
+  tracked_t(tracked_t const& other) : value(other.value) { ++live; };
+  tracked_t& operator=(tracked_t const&) = default;
+  ~tracked_t() { --live; }
+};
+
+/**
+ * @brief Compare deque with std::deque of values element by element
+ */
+template <typename Deque>
+static bool SameValues(Deque const& deque, std::deque<int> const& model) {
+  if (deque.Size() != model.size())
+    return false;
+  size_t i = 0;
+  for (auto const& element : deque)
+    if (element.value != model[i++])
+      return false;
+  return true;
+}
+
+/**
+ * @brief Push and pop at both ends of block deque across many small blocks, copy and clear it
+ */
+static void TestBlockDequeModel() {
+  {
+    using deque_type = block_deque_t<tracked_t, std::allocator<tracked_t>, 4>;
+    deque_type deque;
+    std::deque<int> model;
+    std::mt19937 random(1);
+    for (int step = 0; step < 20000; ++step) {
+      unsigned op = random() % 5;
+      if (op == 0 || (model.empty() && op >= 2)) {
+        deque.PushBack(tracked_t(step));
+        model.push_back(step);
+      }
+      else if (op == 1) {
+        deque.EmplaceFront(step);
+        model.push_front(step);
+      }
+      else if (op == 2 || op == 4) {
+        deque.PopFront();
+        model.pop_front();
+      }
+      else {
+        deque.PopBack();
+        model.pop_back();
+      }
+      if (step % 1000 == 0)
+        DEQUE_CHECK(SameValues(deque, model));
+    }
+    for (int i = 0; i < 100; ++i) {
+      deque.PushBack(tracked_t(i));
+      model.push_back(i);
+    }
+    DEQUE_CHECK(SameValues(deque, model));
+    DEQUE_CHECK(tracked_t::live == (long)model.size());
+    DEQUE_CHECK(deque.Front().value == model.front() && deque.Back().value == model.back());
+    bool indexed = true;
+    for (size_t i = 0; i < model.size(); ++i)
+      indexed &= deque[i].value == model[i] && deque.At(i).value == model[i];
+    DEQUE_CHECK(indexed);
+    DEQUE_CHECK((size_t)(deque.end() - deque.begin()) == model.size());
+    DEQUE_CHECK(deque.rbegin()->value == model.back());
+
+    bool thrown = false;
+    try {
+      deque.At(model.size());
+    }
+    catch (std::out_of_range const&) {
+      thrown = true;
+    }
+    DEQUE_CHECK(thrown);
+
+    size_t segmented = 0;
+    deque.ForEachSegment([&](std::span<tracked_t> part) {
+      for (tracked_t const& element : part)
+        segmented += element.value == model[segmented];
+    });
+    DEQUE_CHECK(segmented == model.size());
+
+    deque_type copy(deque);
+    DEQUE_CHECK(SameValues(copy, model));
+    deque_type moved(std::move(copy));
+    DEQUE_CHECK(SameValues(moved, model) && copy.IsEmpty());
+    copy = deque;
+    DEQUE_CHECK(SameValues(copy, model));
+    DEQUE_CHECK(tracked_t::live == 3 * (long)model.size());
+
+    deque.Clear();
+    deque.ShrinkToFit();
+    DEQUE_CHECK(deque.IsEmpty() && deque.Size() == 0);
+    deque.PushFront(tracked_t(7));
+    DEQUE_CHECK(deque.Size() == 1 && deque.Front().value == 7);
+  }
+  DEQUE_CHECK(tracked_t::live == 0);
+}
+
+/**
+ * @brief Fill static deque while evaluating constant expression
+ * @return sum of elements left after wrapping around the buffer
+ */
+static constexpr int StaticDequeSum() {
+  static_deque_t<int, 4> deque = {1, 2, 3};
+  deque.PopFront();
+  deque.PushBack(4);
+  deque.PushBack(5);
+  deque.PopFront();
+  deque.PushFront(10);
+  int sum = 0;
+  for (int value : deque)
+    sum += value;
+  return sum + (deque.IsFull() ? 100 : 0);
+}
+
+/**
+ * @brief Run static deque at its capacity, wrapping around, and in constant expressions
+ */
+static void TestStaticDeque() {
+  static_assert(StaticDequeSum() == 10 + 3 + 4 + 5 + 100, "static_deque_t must work in constant expressions");
+
+  {
+    using deque_type = static_deque_t<tracked_t, 5>;
+    static_assert(deque_type::Capacity() == 5, "capacity of static_deque_t");
+    deque_type deque;
+    std::deque<int> model;
+    for (int step = 0; step < 1000; ++step) {
+      if (step % 3 != 2) {
+        bool pushed = step % 2 == 0 ? deque.TryPushBack(tracked_t(step)) : deque.TryPushFront(tracked_t(step));
+        DEQUE_CHECK(pushed == (model.size() < 5));
+        if (pushed && step % 2 == 0)
+          model.push_back(step);
+        else if (pushed)
+          model.push_front(step);
+      }
+      else if (step % 4 < 2) {
+        deque.PopFront();
+        model.pop_front();
+      }
+      else {
+        deque.PopBack();
+        model.pop_back();
+      }
+    }
+    DEQUE_CHECK(SameValues(deque, model));
+    DEQUE_CHECK(tracked_t::live == (long)model.size());
+
+    while (!deque.IsFull()) {
+      deque.PushBack(tracked_t(-1));
+      model.push_back(-1);
+    }
+    bool thrown = false;
+    try {
+      deque.EmplaceFront(0);
+    }
+    catch (std::length_error const&) {
+      thrown = true;
+    }
+    DEQUE_CHECK(thrown && deque.Size() == 5);
+    thrown = false;
+    try {
+      deque.At(5);
+    }
+    catch (std::out_of_range const&) {
+      thrown = true;
+    }
+    DEQUE_CHECK(thrown);
+    DEQUE_CHECK(deque[4].value == model[4] && deque.Back().value == model.back());
+
+    deque_type copy(deque);
+    deque_type moved(std::move(copy));
+    DEQUE_CHECK(SameValues(moved, model));
+    copy = moved;
+    DEQUE_CHECK(SameValues(copy, model));
+    copy.Clear();
+    DEQUE_CHECK(copy.IsEmpty());
+  }
+  DEQUE_CHECK(tracked_t::live == 0);
+}
+
+/**
+ * @brief Allocator equal only to allocators with the same tag
+ */
+template <typename T>
+struct tagged_allocator {
+  using value_type = T;
+
+  static inline long live = 0;        ///< number of not deallocated allocations of all types
+
+  int tag;                            ///< allocators with different tags cannot free each other's memory
+
+  explicit tagged_allocator(int tag = 0) : tag(tag) {};
+  template <typename U>
+  tagged_allocator(tagged_allocator<U> const& other) : tag(other.tag) {};
+
+  T* allocate(size_t n) {
+    ++tagged_allocator<char>::live;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, size_t n) {
+    --tagged_allocator<char>::live;
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template <typename U>
+  bool operator==(tagged_allocator<U> const& other) const { return tag == other.tag; }
+};
+
+/**
+ * @brief Collect values of deque
+ */
+template <typename Deque>
+static std::vector<int> ValuesOf(Deque const& deque) {
+  std::vector<int> values;
+  for (auto const& element : deque)
+    values.push_back(element);
+  return values;
+}
+
+/**
+ * @brief Splice and split deques with equal and different allocators
+ */
+static void TestSplice() {
+  using deque_type = deque_t<int, tagged_allocator<int>>;
+  {
+    deque_type deque({3, 4}, tagged_allocator<int>(1));
+    deque_type back({5, 6, 7}, tagged_allocator<int>(1));
+    deque_type front({1, 2}, tagged_allocator<int>(1));
+    int* relinked = &back.Front();
+    long live = tagged_allocator<char>::live;
+
+    // equal allocators relink nodes without allocation
+    deque.SpliceBack(std::move(back));
+    deque.SpliceFront(std::move(front));
+    DEQUE_CHECK(ValuesOf(deque) == std::vector<int>({1, 2, 3, 4, 5, 6, 7}));
+    DEQUE_CHECK(deque.Size() == 7 && back.IsEmpty() && front.IsEmpty());
+    DEQUE_CHECK(&*std::next(deque.begin(), 4) == relinked && tagged_allocator<char>::live == live);
+    deque.SpliceBack(std::move(deque));
+    DEQUE_CHECK(deque.Size() == 7);
+
+    // different allocators move elements one by one
+    deque_type other({8, 9}, tagged_allocator<int>(2));
+    deque_type first({-1, 0}, tagged_allocator<int>(2));
+    deque.SpliceBack(std::move(other));
+    deque.SpliceFront(std::move(first));
+    DEQUE_CHECK(ValuesOf(deque) == std::vector<int>({-1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    DEQUE_CHECK(other.IsEmpty() && first.IsEmpty());
+
+    // split near the back and near the front of the deque
+    deque_type tail = deque.SplitAt(std::next(deque.begin(), 8));
+    DEQUE_CHECK(ValuesOf(tail) == std::vector<int>({7, 8, 9}) && tail.Size() == 3);
+    deque_type rest = deque.SplitAt(std::next(deque.begin(), 1));
+    DEQUE_CHECK(ValuesOf(deque) == std::vector<int>({-1}) && deque.Size() == 1);
+    DEQUE_CHECK(ValuesOf(rest) == std::vector<int>({0, 1, 2, 3, 4, 5, 6}) && rest.Size() == 7);
+    deque_type none = rest.SplitAt(rest.end());
+    DEQUE_CHECK(none.IsEmpty() && rest.Size() == 7);
+    deque_type all = rest.SplitAt(rest.begin());
+    DEQUE_CHECK(rest.IsEmpty() && all.Size() == 7 && all.Back() == 6);
+    rest.PushBack(10);
+    all.SpliceBack(std::move(rest));
+    DEQUE_CHECK(all.Size() == 8 && all.Back() == 10);
+  }
+  DEQUE_CHECK(tagged_allocator<char>::live == 0);
+}
+
+/**
+ * @brief Move nodes between deques through handles, insert and erase in the middle
+ */
+static void TestNodeHandles() {
+  using deque_type = deque_t<tracked_t, tagged_allocator<tracked_t>>;
+  {
+    deque_type source({tracked_t(1), tracked_t(2), tracked_t(3), tracked_t(4)}, tagged_allocator<tracked_t>(1));
+    deque_type target({tracked_t(10), tracked_t(20)}, tagged_allocator<tracked_t>(1));
+    long allocations = tagged_allocator<char>::live;
+
+    // extracted node keeps its address and is relinked with no allocation
+    deque_type::iterator second = std::next(source.begin());
+    tracked_t* element = &*second;
+    deque_type::node_handle_t handle = source.Extract(second);
+    DEQUE_CHECK(handle && !handle.IsEmpty() && handle.Value().value == 2);
+    DEQUE_CHECK(source.Size() == 3 && tracked_t::live == 6);
+    deque_type::iterator inserted = target.Insert(std::next(target.begin()), std::move(handle));
+    DEQUE_CHECK(&*inserted == element && handle.IsEmpty());
+    DEQUE_CHECK(tagged_allocator<char>::live == allocations && tracked_t::live == 6);
+    DEQUE_CHECK(target.Size() == 3 && target.Front().value == 10 && inserted->value == 2);
+    DEQUE_CHECK(target.Insert(target.end(), deque_type::node_handle_t()) == target.end() && target.Size() == 3);
+
+    // handle moved around and dropped frees its node
+    deque_type::node_handle_t moved(source.Extract(source.begin()));
+    deque_type::node_handle_t assigned;
+    assigned = std::move(moved);
+    DEQUE_CHECK(moved.IsEmpty() && assigned.Value().value == 1);
+    assigned = source.Extract(source.begin());
+    DEQUE_CHECK(assigned.Value().value == 3 && tracked_t::live == 5);
+    assigned = deque_type::node_handle_t();
+    DEQUE_CHECK(tracked_t::live == 4 && tagged_allocator<char>::live == allocations - 2);
+
+    // node of a different allocator is moved to a new node
+    deque_type other({tracked_t(7)}, tagged_allocator<tracked_t>(2));
+    inserted = target.Insert(target.end(), other.Extract(other.begin()));
+    DEQUE_CHECK(inserted->value == 7 && other.IsEmpty() && target.Back().value == 7);
+    DEQUE_CHECK(tracked_t::live == 5);
+
+    // insert and erase single elements and ranges
+    target.Insert(target.begin(), tracked_t(0));
+    target.Emplace(std::next(target.begin(), 2), 15);
+    std::vector<int> values;
+    for (tracked_t const& value : target)
+      values.push_back(value.value);
+    DEQUE_CHECK(values == std::vector<int>({0, 10, 15, 2, 20, 7}));
+    deque_type::iterator next = target.Erase(std::next(target.begin()));
+    DEQUE_CHECK(next->value == 15 && target.Size() == 5);
+    next = target.Erase(next, std::next(next, 3));
+    DEQUE_CHECK(next->value == 7 && target.Size() == 2 && target.Front().value == 0);
+    DEQUE_CHECK(target.Erase(next, next) == next && target.Size() == 2);
+    DEQUE_CHECK(tracked_t::live == 3);
+  }
+  DEQUE_CHECK(tracked_t::live == 0 && tagged_allocator<char>::live == 0);
+}
+
+/**
+ * @brief Time out pops, block pushes on full deque, wake blocked threads by Close
+ */
+static void TestBlockingDeque() {
+  using namespace std::chrono_literals;
+  {
+    blocking_deque_t<int> deque(2);
+    int value = 0;
+    auto start = std::chrono::steady_clock::now();
+    DEQUE_CHECK(!deque.WaitPopFront(value, 20ms));
+    DEQUE_CHECK(std::chrono::steady_clock::now() - start >= 20ms);
+
+    DEQUE_CHECK(deque.TryPushBack(1) && deque.TryPushFront(0));
+    DEQUE_CHECK(!deque.TryPushBack(2) && deque.Size() == 2);
+    DEQUE_CHECK(deque.WaitPopFront(value, 1s) && value == 0);
+
+    // full deque blocks the push until a pop makes room
+    DEQUE_CHECK(deque.TryPushBack(2));
+    std::atomic<bool> pushed(false);
+    std::thread producer([&]() {
+      pushed = deque.PushBackOrBlock(3);
+    });
+    std::this_thread::sleep_for(20ms);
+    DEQUE_CHECK(!pushed.load());
+    DEQUE_CHECK(deque.TryPopFront(value) && value == 1);
+    producer.join();
+    DEQUE_CHECK(pushed.load() && deque.Size() == 2);
+
+    // Close fails the blocked push, queued elements are still popped
+    std::thread blocked([&]() {
+      pushed = deque.PushBackOrBlock(4);
+    });
+    std::this_thread::sleep_for(20ms);
+    deque.Close();
+    blocked.join();
+    DEQUE_CHECK(!pushed.load() && deque.IsClosed() && !deque.TryPushBack(5));
+    DEQUE_CHECK(deque.WaitPopFront(value) && value == 2);
+    DEQUE_CHECK(deque.WaitPopFront(value, 1s) && value == 3);
+    DEQUE_CHECK(!deque.WaitPopFront(value) && deque.IsEmpty());
+  }
+  {
+    // Close wakes a pop waiting without timeout
+    blocking_deque_t<int> deque;
+    std::atomic<int> result(-1);
+    std::thread consumer([&]() {
+      int value = 0;
+      result = deque.WaitPopFront(value) ? 1 : 0;
+    });
+    std::this_thread::sleep_for(20ms);
+    deque.Close();
+    consumer.join();
+    DEQUE_CHECK(result.load() == 0);
+  }
+  {
+    // bounded deque passes every element once between threads
+    blocking_deque_t<int> deque(8);
+    int const count = 20000;
+    std::vector<int> seen(count, 0);
+    std::vector<std::thread> consumers;
+    for (int t = 0; t < 3; ++t)
+      consumers.emplace_back([&]() {
+        int value = 0;
+        while (deque.WaitPopFront(value))
+          ++seen[value];
+      });
+    for (int i = 0; i < count; ++i)
+      deque.PushBackOrBlock(i);
+    while (!deque.IsEmpty())
+      std::this_thread::yield();
+    deque.Close();
+    for (auto& consumer : consumers)
+      consumer.join();
+    int wrong = 0;
+    for (int i = 0; i < count; ++i)
+      wrong += seen[i] != 1;
+    DEQUE_CHECK(wrong == 0);
+  }
+}
+
+/**
+ * @brief Fill and wrap SPSC ring, stream elements in order between two threads
+ */
+static void TestSpscQueue() {
+  {
+    spsc_queue_t<tracked_t> queue(5);
+    DEQUE_CHECK(queue.Capacity() == 8 && queue.IsEmpty());
+    tracked_t value(0);
+    for (int round = 0; round < 3; ++round) {
+      for (int i = 0; i < 8; ++i)
+        DEQUE_CHECK(queue.TryPushBack(tracked_t(round * 10 + i)));
+      DEQUE_CHECK(!queue.TryPushBack(value) && queue.Size() == 8);
+      for (int i = 0; i < 5; ++i)
+        DEQUE_CHECK(queue.TryPopFront(value) && value.value == round * 10 + i);
+      while (queue.TryPopFront(value)) {}
+    }
+    DEQUE_CHECK(queue.IsEmpty() && tracked_t::live == 1);
+
+    std::vector<tracked_t> values;
+    for (int i = 0; i < 12; ++i)
+      values.emplace_back(i);
+    DEQUE_CHECK(queue.TryPushBackN(values.begin(), values.size()) == 8);
+    std::vector<tracked_t> popped;
+    DEQUE_CHECK(queue.TryPopFrontN(std::back_inserter(popped), 3) == 3);
+    DEQUE_CHECK(queue.TryPushBackN(values.begin() + 8, 4) == 3);
+    DEQUE_CHECK(queue.TryPopFrontN(std::back_inserter(popped), 100) == 8);
+    bool ordered = popped.size() == 11;
+    for (size_t i = 0; ordered && i < popped.size(); ++i)
+      ordered = popped[i].value == (int)i;
+    DEQUE_CHECK(ordered && queue.IsEmpty());
+    DEQUE_CHECK(queue.TryPushBack(value) && queue.TryPushBack(value));
+  }
+  DEQUE_CHECK(tracked_t::live == 0);
+
+  spsc_queue_t<int> queue(64);
+  int const count = 200000;
+  std::thread producer([&]() {
+    int next = 0;
+    int batch[16];
+    while (next < count) {
+      if (next % 3 == 0) {
+        if (queue.TryPushBack(next))
+          ++next;
+        else
+          std::this_thread::yield();
+        continue;
+      }
+      int n = std::min(16, count - next);
+      for (int i = 0; i < n; ++i)
+        batch[i] = next + i;
+      size_t pushed = queue.TryPushBackN(batch, (size_t)n);
+      if (pushed == 0)
+        std::this_thread::yield();
+      next += (int)pushed;
+    }
+  });
+  int expected = 0;
+  int wrong = 0;
+  std::vector<int> popped;
+  while (expected < count) {
+    int value = 0;
+    if (expected % 2 == 0) {
+      if (queue.TryPopFront(value))
+        wrong += value != expected++;
+      else
+        std::this_thread::yield();
+      continue;
+    }
+    popped.clear();
+    if (queue.TryPopFrontN(std::back_inserter(popped), 10) == 0)
+      std::this_thread::yield();
+    for (int element : popped)
+      wrong += element != expected++;
+  }
+  producer.join();
+  DEQUE_CHECK(wrong == 0 && queue.IsEmpty());
+}
+
+/**
+ * @brief Owner pushes and pops back while thieves steal, every element is taken once
+ */
+static void TestWorkStealing() {
+  {
+    work_stealing_deque_t<int> deque(2);
+    int value = 0;
+    DEQUE_CHECK(!deque.PopBack(value) && !deque.Steal(value) && deque.IsEmpty());
+    for (int i = 0; i < 10; ++i)
+      deque.PushBack(i);
+    DEQUE_CHECK(deque.Size() == 10);
+    DEQUE_CHECK(deque.PopBack(value) && value == 9);
+    DEQUE_CHECK(deque.Steal(value) && value == 0);
+    DEQUE_CHECK(deque.Size() == 8);
+  }
+
+  int const count = 100000;
+  int const thieves = 3;
+  work_stealing_deque_t<int> deque(4);
+  std::atomic<bool> done(false);
+  std::vector<int> taken[thieves + 1];
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thieves; ++t)
+    threads.emplace_back([&, t]() {
+      int value = 0;
+      while (!done.load(std::memory_order_acquire) || !deque.IsEmpty())
+        if (deque.Steal(value))
+          taken[t].push_back(value);
+        else
+          std::this_thread::yield();
+    });
+
+  // the owner keeps the deque short, so its pops race with steals for the last elements
+  int value = 0;
+  for (int i = 0; i < count; ++i) {
+    deque.PushBack(i);
+    if (i % 3 == 0 && deque.PopBack(value))
+      taken[thieves].push_back(value);
+  }
+  while (deque.PopBack(value))
+    taken[thieves].push_back(value);
+  done.store(true, std::memory_order_release);
+  for (auto& thread : threads)
+    thread.join();
+
+  std::vector<int> seen(count, 0);
+  for (auto const& values : taken)
+    for (int element : values)
+      ++seen[element];
+  int wrong = 0;
+  for (int i = 0; i < count; ++i)
+    wrong += seen[i] != 1;
+  DEQUE_CHECK(wrong == 0);
+  // each thief takes elements from the front, so it sees them in push order
+  for (int t = 0; t < thieves; ++t)
+    DEQUE_CHECK(std::is_sorted(taken[t].begin(), taken[t].end()));
+}
+
+/**
+ * @brief Find the greatest value of window and its last position by brute force
+ * @param[in] values all values
+ * @param[in] first position of the first value of the window
+ * @param[in] last position after the last value of the window
+ * @param[in] compare ordering of values
+ * @return position of the last occurrence of the greatest value
+ */
+template <typename Compare>
+static size_t BruteTop(std::vector<int> const& values, size_t first, size_t last, Compare compare) {
+  size_t top = first;
+  for (size_t i = first; i < last; ++i)
+    if (!compare(values[i], values[top]))
+      top = i;
+  return top;
+}
+
+/**
+ * @brief Compare sliding window maximum and minimum with brute force, one by one and in bursts
+ */
+template <typename Compare>
+static void TestMonotonicWindow() {
+  std::mt19937 random(7);
+  std::vector<int> values(5000);
+  for (int& value : values)
+    value = (int)(random() % 50);
+  size_t const window = 37;
+
+  monotonic_deque_t<int, Compare> deque;
+  int wrong = 0;
+  for (size_t i = 0; i < values.size(); ++i) {
+    DEQUE_CHECK(deque.Push(values[i]) == i);
+    size_t first = i + 1 >= window ? i + 1 - window : 0;
+    deque.Evict(first);
+    size_t top = BruteTop(values, first, i + 1, Compare());
+    wrong += deque.Top() != values[top] || deque.TopKey() != top;
+  }
+  DEQUE_CHECK(wrong == 0 && deque.Size() <= window);
+
+  // bursts skip dominated values but keep the numbering
+  deque.Clear();
+  DEQUE_CHECK(deque.IsEmpty());
+  for (size_t end = 0; end < values.size();) {
+    size_t next = std::min(values.size(), end + 1 + random() % 60);
+    deque.PushBatch(values.begin() + end, values.begin() + next);
+    end = next;
+    size_t first = end >= window ? end - window : 0;
+    deque.Evict(first);
+    size_t top = BruteTop(values, first, end, Compare());
+    wrong += deque.IsEmpty() || deque.Top() != values[top] || deque.TopKey() != top;
+  }
+  DEQUE_CHECK(wrong == 0);
+
+  // explicit keys are timestamps shared by several values
+  monotonic_deque_t<int, Compare, int64_t> timed;
+  std::vector<int64_t> times(values.size());
+  for (size_t i = 0; i < times.size(); ++i)
+    times[i] = (int64_t)(i / 3);
+  int64_t const span = 10;
+  for (size_t end = 0; end < values.size();) {
+    size_t next = std::min(values.size(), end + 1 + random() % 8);
+    if (next == end + 1)
+      timed.Push(times[end], values[end]);
+    else
+      timed.PushBatch(times.begin() + end, values.begin() + end, next - end);
+    end = next;
+    int64_t oldest = times[end - 1] - span;
+    timed.Evict(oldest);
+    size_t first = 0;
+    while (times[first] < oldest)
+      ++first;
+    size_t top = BruteTop(values, first, end, Compare());
+    wrong += timed.Top() != values[top] || timed.TopKey() != times[top];
+  }
+  DEQUE_CHECK(wrong == 0);
+}
+
+/**
+ * @brief Push and pop at both ends of deque with the not thread-safe interface
+ * @param[in] deque empty deque
+ * @return true if the elements come out in order
+ */
+template <typename Deque>
+static bool FillAndDrain(Deque&& deque) {
+  for (int i = 0; i < 4; ++i) {
+    deque.PushBack(10 + i);
+    deque.PushFront(9 - i);
+  }
+  bool ordered = deque.Size() == 8 && deque.Front() == 6 && deque.Back() == 13;
+  for (int i = 6; i < 10 && ordered; ++i) {
+    ordered = deque.Front() == i;
+    deque.PopFront();
+  }
+  for (int i = 13; i >= 10 && ordered; --i) {
+    ordered = deque.Back() == i;
+    deque.PopBack();
+  }
+  return ordered && deque.IsEmpty();
+}
+
+/**
+ * @brief Push from several threads and pop everything through the TryPush/TryPop interface
+ * @param[in] deque empty thread-safe deque
+ * @return true if every element was popped once
+ */
+template <typename Deque>
+static bool ShareBetweenThreads(Deque& deque) {
+  int const count = 2000;
+  std::atomic<int> failed(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([&, t]() {
+      for (int i = t; i < count; i += 4)
+        failed += !(i % 2 == 0 ? deque.TryPushBack(i) : deque.TryPushFront(i));
+    });
+  for (auto& thread : threads)
+    thread.join();
+  std::vector<int> seen(count, 0);
+  int value = 0;
+  while (deque.TryPopFront(value) || deque.TryPopBack(value))
+    ++seen[value];
+  return failed.load() == 0 && std::count(seen.begin(), seen.end(), 1) == count;
+}
+
+/**
+ * @brief Select containers by policy bundles and run them
+ */
+static void TestPolicyBundles() {
+  using alloc_type = std::allocator<int>;
+  using list_type = deque_t<int, alloc_type, deque_policy<>>;
+  using stats_type = deque_t<int, alloc_type, deque_policy<deque_storage::list, deque_growth::doubling, deque_sync::none, deque_stats_on>>;
+  using blocks_type = deque_t<int, alloc_type, deque_policy<deque_storage::blocks<8>>>;
+  using bytes_type = deque_t<int, alloc_type, deque_policy<deque_storage::blocks_of_bytes<64>>>;
+  using ring_type = deque_t<int, alloc_type, deque_policy<deque_storage::ring<4>>>;
+  using fixed_type = deque_t<int, alloc_type, deque_policy<deque_storage::ring<>, deque_growth::fixed<8>>>;
+  using locked_type = deque_t<int, alloc_type, deque_policy<deque_storage::blocks<>, deque_growth::doubling, deque_sync::mutex>>;
+  using locked_fixed_type = deque_t<int, alloc_type, deque_policy<deque_storage::ring<>, deque_growth::fixed<4>, deque_sync::mutex>>;
+  using lock_free_type = deque_t<int, alloc_type, deque_policy<deque_storage::list, deque_growth::doubling, deque_sync::lock_free>>;
+
+  static_assert(std::is_base_of_v<deque_t<int, alloc_type>, list_type>, "list storage selects deque_t");
+  static_assert(std::is_base_of_v<deque_t<int, alloc_type, deque_stats_on>, stats_type>, "statistics are passed to deque_t");
+  static_assert(std::is_base_of_v<block_deque_t<int, alloc_type, 8>, blocks_type>, "block storage selects block_deque_t");
+  static_assert(std::is_base_of_v<block_deque_t<int, alloc_type, 16>, bytes_type>, "64 bytes hold 16 ints");
+  static_assert(std::is_base_of_v<ring_deque_t<int, alloc_type, 4>, ring_type>, "ring storage selects ring_deque_t");
+  static_assert(std::is_base_of_v<static_deque_t<int, 8>, fixed_type>, "fixed growth selects static_deque_t");
+  static_assert(std::is_base_of_v<locked_deque_t<block_deque_t<int, alloc_type, DefaultBlockSize<int>()>>, locked_type>,
+    "mutex wraps the container");
+  static_assert(std::is_base_of_v<concurrent_deque_t<int, alloc_type>, lock_free_type>, "lock-free selects concurrent_deque_t");
+
+  DEQUE_CHECK(FillAndDrain(list_type()));
+  stats_type stats;
+  DEQUE_CHECK(FillAndDrain(stats) && stats.Stats().pushBack == 4 && stats.Stats().popFront == 4);
+  DEQUE_CHECK(FillAndDrain(blocks_type()));
+  DEQUE_CHECK(FillAndDrain(bytes_type()));
+  DEQUE_CHECK(FillAndDrain(ring_type()));
+  fixed_type fixed;
+  DEQUE_CHECK(FillAndDrain(fixed));
+  for (int i = 0; i < 8; ++i)
+    fixed.PushBack(i);
+  DEQUE_CHECK(!fixed.TryPushBack(8) && fixed.IsFull());
+
+  locked_type locked;
+  DEQUE_CHECK(ShareBetweenThreads(locked));
+  DEQUE_CHECK(locked.WithLock([](auto& deque) { return FillAndDrain(deque); }));
+  locked_fixed_type lockedFixed;
+  int pushed = 0;
+  while (lockedFixed.TryPushBack(pushed))
+    ++pushed;
+  DEQUE_CHECK(pushed == 4 && lockedFixed.Size() == 4);
+  lock_free_type lockFree(4096);
+  DEQUE_CHECK(ShareBetweenThreads(lockFree));
+}
+
+int main(void) {
+  TestRingPushOwnElement<ring_deque_t<std::string>>();
+  TestRingPushOwnElement<small_deque_t<std::string, 4>>();
+  TestStatsMiddleOperations();
+  TestSerializeBackToBack();
+  TestSerializeLoader();
+#if defined(__unix__) || defined(__APPLE__)
+  TestMmapReopenEnlargedFile();
+#endif
+
+  TestConcurrentSmallCapacity();
+  TestConcurrentStress();
+#if defined(__unix__) || defined(__APPLE__)
+  TestMmapPushOwnElement();
+#endif
+  TestDequeCopyFailure();
+  TestArenaClear();
+  TestIntrusiveTaggedHooks();
+  TestSimdKernels<float>();
+  TestSimdKernels<double>();
+  TestSimdKernels<int32_t>();
+  TestSimdKernels<int64_t>();
+  TestSimdDeques();
+  TestCachingAllocator<system_chunk_source>();
+  TestCachingAllocator<numa_chunk_source>();
+  TestAsyncWakeOrder();
+  TestAsyncBatchFailure();
+  TestAsyncExecutor();
+  TestBlockDequeModel();
+  TestStaticDeque();
+  TestSplice();
+  TestNodeHandles();
+  TestBlockingDeque();
+  TestSpscQueue();
+  TestWorkStealing();
+  TestMonotonicWindow<std::less<int>>();
+  TestMonotonicWindow<std::greater<int>>();
+  TestPolicyBundles();
+  if (failures != 0)
+    std::fprintf(stderr, "%d checks failed\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+/**
+ * @brief Work-stealing deque class
+ *
+ * Chase-Lev deque with the memory orderings of N. M. Le et al. ("Correct and Efficient
+ * Work-Stealing for Weak Memory Models", 2013). The owner thread pushes and pops at the back,
+ * other threads steal from the front. Owner operations never wait for thieves, a steal
+ * costs one CAS. The circular array grows twice when full; replaced arrays are kept
+ * until destruction because a thief may still read from them.
+ *
+ * @tparam T type of stored elements (must be trivially copyable, e.g. task pointer)
+ * @tparam Allocator the allocator to be used
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class work_stealing_deque_t {
+  static_assert(std::is_trivially_copyable<T>::value, "work_stealing_deque_t requires trivially copyable T");
+
+private:
+  /**
+   * @brief Circular array class
+   */
+  struct array_t {
+    std::atomic<T>* slots;    ///< elements of the array
+    int64_t mask;             ///< capacity minus one (capacity is power of two)
+    array_t* previous;        ///< replaced array kept alive for thieves (nullptr for the first one)
+
+    /**
+     * @brief Get capacity of array
+     * @return number of slots
+     */
+    int64_t Capacity() const {
+      return mask + 1;
+    }
+
+    /**
+     * @brief Read element
+     * @param[in] index unwrapped position
+     * @return the element
+     */
+    T Get(int64_t index) const {
+      return slots[index & mask].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Write element
+     * @param[in] index unwrapped position
+     * @param[in] value the element
+     */
+    void Put(int64_t index, T value) {
+      slots[index & mask].store(value, std::memory_order_relaxed);
+    }
+  };
+
+  using alloc_traits = std::allocator_traits<Allocator>;  //allocator traits
+  using array_allocator = typename alloc_traits::template rebind_alloc<array_t>;
+  using array_allocator_traits = typename alloc_traits::template rebind_traits<array_t>;
+  using slot_allocator = typename alloc_traits::template rebind_alloc<std::atomic<T>>;
+  using slot_allocator_traits = typename alloc_traits::template rebind_traits<std::atomic<T>>;
+
+  alignas(64) std::atomic<int64_t> top;       ///< position of the front element, advanced by thieves
+  alignas(64) std::atomic<int64_t> bottom;    ///< position after the back element, changed by the owner only
+  std::atomic<array_t*> array;                ///< the current circular array
+
+  array_allocator arrayAlloc;                 ///< the allocator for array headers
+  slot_allocator slotAlloc;                   ///< the allocator for array slots
+
+  /**
+   * @brief Allocate circular array
+   * @param[in] capacity number of slots (power of two)
+   * @param[in] previous replaced array to keep
+   * @return pointer to the array
+   */
+  array_t* NewArray(int64_t capacity, array_t* previous) {
+    array_t* result = array_allocator_traits::allocate(arrayAlloc, 1);
+    try {
+      result->slots = slot_allocator_traits::allocate(slotAlloc, (size_t)capacity);
+    }
+    catch (...) {
+      array_allocator_traits::deallocate(arrayAlloc, result, 1);
+      throw;
+    }
+    for (int64_t i = 0; i < capacity; ++i)
+      ::new (static_cast<void*>(result->slots + i)) std::atomic<T>();
+    result->mask = capacity - 1;
+    result->previous = previous;
+    return result;
+  }
+
+  /**
+   * @brief Replace full array with twice larger one
+   * @param[in] old the current array
+   * @param[in] b the current bottom
+   * @param[in] t the current top
+   * @return the new array
+   */
+  array_t* Grow(array_t* old, int64_t b, int64_t t) {
+    array_t* grown = NewArray(old->Capacity() * 2, old);
+    for (int64_t i = t; i < b; ++i)
+      grown->Put(i, old->Get(i));
+    array.store(grown, std::memory_order_release);
+    return grown;
+  }
+
+public:
+  /**
+   * @brief Constructor of empty deque
+   * @param[in] capacity initial capacity (rounded up to power of two)
+   * @param[in] alloc allocator to use in deque
+   */
+  work_stealing_deque_t(size_t capacity = 64, Allocator const& alloc = Allocator())
+    : top(0), bottom(0), arrayAlloc(alloc), slotAlloc(alloc) {
+    int64_t rounded = 1;
+    while (rounded < (int64_t)capacity)
+      rounded *= 2;
+    array.store(NewArray(rounded, nullptr), std::memory_order_relaxed);
+  }
+
+  work_stealing_deque_t(work_stealing_deque_t const&) = delete;
+  work_stealing_deque_t& operator=(work_stealing_deque_t const&) = delete;
+
+  /**
+   * @brief Check is deque empty method
+   * @return true if deque was empty at the moment of the check, false otherwise
+   */
+  bool IsEmpty() const {
+    return Size() == 0;
+  }
+
+  /**
+   * @brief Get deque size method
+   * @return number of elements at the moment of the check
+   */
+  size_t Size() const {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_relaxed);
+    return b > t ? (size_t)(b - t) : 0;
+  }
+
+  /**
+   * @brief Put element to end of deque
+   * @param[in] value element to add
+   * @warning may be called by the owner thread only
+   */
+  void PushBack(T value) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    array_t* a = array.load(std::memory_order_relaxed);
+
+    if (b - t > a->mask)
+      a = Grow(a, b, t);
+
+    a->Put(b, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Remove element from the back of deque
+   * @param[out] value removed element
+   * @return false if the deque is empty, true otherwise
+   * @warning may be called by the owner thread only
+   */
+  bool PopBack(T& value) {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    array_t* a = array.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    value = a->Get(b);
+    if (t == b) {
+      // the last element: race against thieves for it
+      bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Remove element from the front of deque
+   * @param[out] value removed element
+   * @return false if the deque is empty or the element was taken by other thread, true otherwise
+   */
+  bool Steal(T& value) {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b)
+      return false;
+
+    array_t* a = array.load(std::memory_order_acquire);
+    T stolen = a->Get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return false;
+
+    value = stolen;
+    return true;
+  }
+
+  /**
+   * @brief Deque destructor
+   * @warning no other thread may use the deque during destruction
+   */
+  ~work_stealing_deque_t() {
+    array_t* a = array.load(std::memory_order_relaxed);
+    while (a != nullptr) {
+      array_t* previous = a->previous;
+      slot_allocator_traits::deallocate(slotAlloc, a->slots, (size_t)a->Capacity());
+      array_allocator_traits::deallocate(arrayAlloc, a, 1);
+      a = previous;
+    }
+  }
+};